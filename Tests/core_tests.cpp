@@ -0,0 +1,305 @@
+// Core regression tests. They run outside the watch target, against the C++
+// core only; from the repository root:
+//
+//   g++ -std=gnu++20 -O2 -I"nes Watch App/Core/include" "nes Watch App/Core/src/"*.cpp
+//       "nes Watch App/Core/src/mapper/"*.cpp Tests/core_tests.cpp -o core_tests -lpthread
+//   ./core_tests
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "nes_internal.hpp"
+#include "nesc.hpp"
+
+static int failures = 0;
+
+#define EXPECT(cond)                                                            \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #cond); \
+            failures += 1;                                                      \
+        }                                                                       \
+    } while (0)
+
+// RAM the test program maintains: NMI count, $2002 bits seen since the last
+// NMI, and the bits seen during the previous frame.
+#define TEST_NMI_COUNT 0x10
+#define TEST_STATUS_ACCUM 0x12
+#define TEST_STATUS_FRAME 0x13
+
+// NROM image whose program waits for the PPU, puts nine sprites on line 101
+// and, in the next vblank, makes sprite color 1 white and enables NMI and
+// rendering. The main loop ORs every $2002 read into TEST_STATUS_ACCUM; the
+// NMI handler runs OAM DMA, latches that into TEST_STATUS_FRAME, clears it
+// and counts. With sizeSplit the handler also selects 8x8 sprites and, after
+// a delay that ends around line 60, switches to 8x16.
+static std::vector<uint8_t> test_rom(bool sizeSplit) {
+    static const uint8_t program[] = {
+        0x78,                   // C000 SEI
+        0xD8,                   // C001 CLD
+        0xA2, 0xFF,             // C002 LDX #$FF
+        0x9A,                   // C004 TXS
+        0xAD, 0x02, 0x20,       // C005 LDA $2002
+        0x10, 0xFB,             // C008 BPL $C005
+        0xAD, 0x02, 0x20,       // C00A LDA $2002
+        0x10, 0xFB,             // C00D BPL $C00A
+        0xA2, 0x00,             // C00F LDX #0
+        0xA9, 0xF0,             // C011 LDA #$F0
+        0x9D, 0x00, 0x02,       // C013 STA $0200,X
+        0xE8,                   // C016 INX
+        0xD0, 0xFA,             // C017 BNE $C013
+        0xA2, 0x00,             // C019 LDX #0
+        0xA0, 0x09,             // C01B LDY #9
+        0xA9, 0x64,             // C01D LDA #100
+        0x9D, 0x00, 0x02,       // C01F STA $0200,X
+        0xA9, 0x01,             // C022 LDA #1
+        0x9D, 0x01, 0x02,       // C024 STA $0201,X
+        0xA9, 0x00,             // C027 LDA #0
+        0x9D, 0x02, 0x02,       // C029 STA $0202,X
+        0x8A,                   // C02C TXA
+        0x9D, 0x03, 0x02,       // C02D STA $0203,X
+        0xE8, 0xE8, 0xE8, 0xE8, // C030 INX x4
+        0x88,                   // C034 DEY
+        0xD0, 0xE6,             // C035 BNE $C01D
+        0xAD, 0x02, 0x20,       // C037 LDA $2002
+        0x10, 0xFB,             // C03A BPL $C037
+        0xA9, 0x3F,             // C03C LDA #$3F
+        0x8D, 0x06, 0x20,       // C03E STA $2006
+        0xA9, 0x11,             // C041 LDA #$11
+        0x8D, 0x06, 0x20,       // C043 STA $2006
+        0xA9, 0x30,             // C046 LDA #$30
+        0x8D, 0x07, 0x20,       // C048 STA $2007
+        0xA9, 0x00,             // C04B LDA #0
+        0x8D, 0x05, 0x20,       // C04D STA $2005
+        0x8D, 0x05, 0x20,       // C050 STA $2005
+        0xA9, 0x80,             // C053 LDA #$80
+        0x8D, 0x00, 0x20,       // C055 STA $2000
+        0xA9, 0x1E,             // C058 LDA #$1E
+        0x8D, 0x01, 0x20,       // C05A STA $2001
+        0xAD, 0x02, 0x20,       // C05D LDA $2002
+        0x05, 0x12,             // C060 ORA $12
+        0x85, 0x12,             // C062 STA $12
+        0x4C, 0x5D, 0xC0,       // C064 JMP $C05D
+        0x48,                   // C067 PHA
+        0xA9, 0x00,             // C068 LDA #0
+        0x8D, 0x03, 0x20,       // C06A STA $2003
+        0xA9, 0x02,             // C06D LDA #2
+        0x8D, 0x14, 0x40,       // C06F STA $4014
+        0xA5, 0x12,             // C072 LDA $12
+        0x85, 0x13,             // C074 STA $13
+        0xA9, 0x00,             // C076 LDA #0
+        0x85, 0x12,             // C078 STA $12
+        0xE6, 0x10,             // C07A INC $10
+        0x68,                   // C07C PLA
+        0x40,                   // C07D RTI
+        0x48,                   // C07E PHA
+        0x8A,                   // C07F TXA
+        0x48,                   // C080 PHA
+        0x98,                   // C081 TYA
+        0x48,                   // C082 PHA
+        0xA9, 0x00,             // C083 LDA #0
+        0x8D, 0x03, 0x20,       // C085 STA $2003
+        0xA9, 0x02,             // C088 LDA #2
+        0x8D, 0x14, 0x40,       // C08A STA $4014
+        0xA9, 0x80,             // C08D LDA #$80
+        0x8D, 0x00, 0x20,       // C08F STA $2000
+        0xA0, 0x07,             // C092 LDY #7
+        0xA2, 0x00,             // C094 LDX #0
+        0xCA,                   // C096 DEX
+        0xD0, 0xFD,             // C097 BNE $C096
+        0x88,                   // C099 DEY
+        0xD0, 0xF8,             // C09A BNE $C094
+        0xA9, 0xA0,             // C09C LDA #$A0
+        0x8D, 0x00, 0x20,       // C09E STA $2000
+        0xA5, 0x12,             // C0A1 LDA $12
+        0x85, 0x13,             // C0A3 STA $13
+        0xA9, 0x00,             // C0A5 LDA #0
+        0x85, 0x12,             // C0A7 STA $12
+        0xE6, 0x10,             // C0A9 INC $10
+        0x68,                   // C0AB PLA
+        0xA8,                   // C0AC TAY
+        0x68,                   // C0AD PLA
+        0xAA,                   // C0AE TAX
+        0x68,                   // C0AF PLA
+        0x40                    // C0B0 RTI
+    };
+    std::vector<uint8_t> rom(16 + 16384 + 8192, 0);
+    const uint8_t header[8] = {'N', 'E', 'S', 0x1A, 1, 1, 0, 0};
+    memcpy(rom.data(), header, sizeof(header));
+    uint8_t *prg = rom.data() + 16;
+    memcpy(prg, program, sizeof(program));
+    const uint16_t vectors[3] = {(uint16_t)(sizeSplit ? 0xC07E : 0xC067), 0xC000, 0xC000};
+    for (int i = 0; i < 3; i++) {
+        prg[0x3FFA + i * 2] = (uint8_t)(vectors[i] & 0xFF);
+        prg[0x3FFB + i * 2] = (uint8_t)(vectors[i] >> 8);
+    }
+    // Tile 1 of the low table is the 8x8 sprite; tiles 0 and 1 of the high
+    // table are the two halves of the 8x16 one.
+    uint8_t *chr = prg + 16384;
+    memset(chr + 0x0010, 0xFF, 8);
+    memset(chr + 0x1000, 0xFF, 8);
+    memset(chr + 0x1010, 0xFF, 8);
+    return rom;
+}
+
+template <class Config>
+static uint8_t ram(Machine<Config> &machine, uint16_t addr) {
+    return machine.bus.cpuRead(addr);
+}
+
+// The headless build drops audio and pixels and batches PPU dots, but must
+// raise vblank and NMI on the same frames as the default build.
+static void test_headless_frames() {
+    std::vector<uint8_t> rom = test_rom(false);
+    Machine<HeadlessConfig> *headless = new Machine<HeadlessConfig>();
+    NES *reference = new NES();
+    EXPECT(headless->loadRom(rom.data(), rom.size()));
+    EXPECT(reference->loadRom(rom.data(), rom.size()));
+    for (int i = 0; i < 10; i++) {
+        headless->stepFrame();
+        reference->stepFrame();
+        EXPECT(ram(*headless, TEST_NMI_COUNT) == ram(*reference, TEST_NMI_COUNT));
+    }
+    EXPECT(ram(*headless, TEST_NMI_COUNT) == 7);
+    EXPECT((ram(*headless, TEST_STATUS_FRAME) & 0x80) != 0);
+    delete headless;
+    delete reference;
+}
+
+// Sprite overflow is part of emulation, not drawing: with the sprite limit on,
+// a game reading $2002 sees the same flags whether its frames are skipped.
+static void test_overflow_on_skipped_frames() {
+    std::vector<uint8_t> rom = test_rom(false);
+    NES *drawn = new NES();
+    NES *skipped = new NES();
+    EXPECT(drawn->loadRom(rom.data(), rom.size()));
+    EXPECT(skipped->loadRom(rom.data(), rom.size()));
+    nes_set_sprite_limit(drawn, true);
+    nes_set_sprite_limit(skipped, true);
+    for (int i = 0; i < 10; i++) {
+        nes_step_frame(drawn);
+        nes_skip_frame(skipped);
+        EXPECT(ram(*skipped, TEST_STATUS_FRAME) == ram(*drawn, TEST_STATUS_FRAME));
+    }
+    EXPECT((ram(*drawn, TEST_STATUS_FRAME) & 0x20) != 0);
+    delete drawn;
+    delete skipped;
+}
+
+// The pipeline worker draws on its own PPU copy; every flag the game can read
+// must still come from the emulation PPU and match the serial renderer.
+static void test_overflow_with_pipeline() {
+    std::vector<uint8_t> rom = test_rom(false);
+    NES *serial = new NES();
+    NES *pipelined = new NES();
+    nes_set_pipelined_render(pipelined, true);
+    EXPECT(serial->loadRom(rom.data(), rom.size()));
+    EXPECT(pipelined->loadRom(rom.data(), rom.size()));
+    nes_set_sprite_limit(serial, true);
+    nes_set_sprite_limit(pipelined, true);
+    for (int i = 0; i < 10; i++) {
+        nes_step_frame(serial);
+        nes_step_frame(pipelined);
+        EXPECT(ram(*pipelined, TEST_STATUS_FRAME) == ram(*serial, TEST_STATUS_FRAME));
+        EXPECT(memcmp(nes_framebuffer(pipelined), nes_framebuffer(serial), sizeof(FrameBuffer)) == 0);
+    }
+    EXPECT((ram(*serial, TEST_STATUS_FRAME) & 0x20) != 0);
+    delete serial;
+    delete pipelined;
+}
+
+// A $2000 write on a visible line that switches to 8x16 sprites must redraw
+// the following lines with full-height sprites, not lists built for 8x8.
+static void test_sprite_size_split() {
+    std::vector<uint8_t> rom = test_rom(true);
+    NES *nes = new NES();
+    EXPECT(nes->loadRom(rom.data(), rom.size()));
+    for (int i = 0; i < 10; i++) {
+        nes_step_frame(nes);
+    }
+    const uint32_t *pixels = nes_framebuffer(nes);
+    uint32_t backdrop = pixels[112 * NES_WIDTH + 200];
+    EXPECT(pixels[104 * NES_WIDTH + 4] != backdrop);
+    EXPECT(pixels[112 * NES_WIDTH + 4] != backdrop);
+    EXPECT(pixels[120 * NES_WIDTH + 4] == backdrop);
+    delete nes;
+}
+
+// Attached buffers only receive full-size ARGB frames; indexed and scaled
+// frames must not be published as if they had been drawn there.
+static void test_frame_buffers_publish_argb_only() {
+    std::vector<uint8_t> rom = test_rom(false);
+    std::vector<uint32_t> storage(3 * NES_WIDTH * NES_HEIGHT, 0xABABABABu);
+    uint32_t *buffers[3];
+    for (int i = 0; i < 3; i++) {
+        buffers[i] = storage.data() + i * NES_WIDTH * NES_HEIGHT;
+    }
+    NES *nes = new NES();
+    NES *reference = new NES();
+    EXPECT(nes->loadRom(rom.data(), rom.size()));
+    EXPECT(reference->loadRom(rom.data(), rom.size()));
+    nes_set_frame_buffers(nes, buffers);
+    uint64_t sequence = 0;
+
+    nes_set_indexed_output(nes, true);
+    nes_step_frame(nes);
+    nes_step_frame(reference);
+    nes_set_indexed_output(nes, false);
+    nes_set_output_scale(nes, NES_SCALE_HALF_BOX, false);
+    nes_step_frame(nes);
+    nes_step_frame(reference);
+    EXPECT(nes_acquire_frame(nes, &sequence) == NULL);
+    EXPECT(sequence == 0);
+
+    nes_set_output_scale(nes, NES_SCALE_FULL, false);
+    for (int i = 0; i < 8; i++) {
+        nes_step_frame(nes);
+        nes_step_frame(reference);
+    }
+    const uint32_t *frame = nes_acquire_frame(nes, &sequence);
+    EXPECT(sequence == 8);
+    EXPECT(frame == nes_framebuffer(nes));
+    EXPECT(frame == nes_output_framebuffer(nes));
+    EXPECT(frame != NULL && memcmp(frame, nes_framebuffer(reference), sizeof(FrameBuffer)) == 0);
+    delete nes;
+    delete reference;
+}
+
+// The dot renderer is the exact one; the scanline renderer must draw the same
+// frames, including when $2000 switches sprite size mid-frame.
+static void test_dot_matches_scanline(bool sizeSplit) {
+    std::vector<uint8_t> rom = test_rom(sizeSplit);
+    NES *scanline = new NES();
+    NES *dot = new NES();
+    nes_set_ppu_mode(dot, NES_PPU_DOT);
+    EXPECT(scanline->loadRom(rom.data(), rom.size()));
+    EXPECT(dot->loadRom(rom.data(), rom.size()));
+    nes_set_sprite_limit(scanline, true);
+    nes_set_sprite_limit(dot, true);
+    for (int i = 0; i < 10; i++) {
+        nes_step_frame(scanline);
+        nes_step_frame(dot);
+        EXPECT(ram(*dot, TEST_STATUS_FRAME) == ram(*scanline, TEST_STATUS_FRAME));
+        EXPECT(memcmp(nes_framebuffer(dot), nes_framebuffer(scanline), sizeof(FrameBuffer)) == 0);
+    }
+    delete scanline;
+    delete dot;
+}
+
+int main() {
+    test_headless_frames();
+    test_overflow_on_skipped_frames();
+    test_overflow_with_pipeline();
+    test_sprite_size_split();
+    test_frame_buffers_publish_argb_only();
+    test_dot_matches_scanline(false);
+    test_dot_matches_scanline(true);
+    if (failures != 0) {
+        fprintf(stderr, "%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("all tests passed\n");
+    return 0;
+}
@@ -9,12 +9,14 @@ typealias NESRef = OpaquePointer
 @_silgen_name("nes_load_rom") private func nes_load_rom(_ nes: NESRef, _ data: UnsafePointer<UInt8>, _ size: Int) -> Bool
 @_silgen_name("nes_reset") private func nes_reset(_ nes: NESRef)
 @_silgen_name("nes_step_frame") private func nes_step_frame(_ nes: NESRef)
-@_silgen_name("nes_framebuffer") private func nes_framebuffer(_ nes: NESRef) -> UnsafePointer<UInt32>?
-@_silgen_name("nes_framebuffer_width") private func nes_framebuffer_width() -> Int32
-@_silgen_name("nes_framebuffer_height") private func nes_framebuffer_height() -> Int32
+@_silgen_name("nes_output_framebuffer") private func nes_output_framebuffer(_ nes: NESRef) -> UnsafePointer<UInt32>?
+@_silgen_name("nes_output_width") private func nes_output_width(_ nes: NESRef) -> Int32
+@_silgen_name("nes_output_height") private func nes_output_height(_ nes: NESRef) -> Int32
+@_silgen_name("nes_set_change_tracking") private func nes_set_change_tracking(_ nes: NESRef, _ enabled: Bool)
+@_silgen_name("nes_frame_unchanged") private func nes_frame_unchanged(_ nes: NESRef) -> Bool
 @_silgen_name("nes_set_button") private func nes_set_button(_ nes: NESRef, _ button: UInt8, _ pressed: Bool)
-@_silgen_name("nes_apu_next_sample") private func nes_apu_next_sample(_ nes: NESRef, _ sampleRate: Double) -> Float
-@_silgen_name("nes_apu_fill_buffer") private func nes_apu_fill_buffer(_ nes: NESRef, _ sampleRate: Double, _ out: UnsafeMutablePointer<Float>, _ count: Int32)
+@_silgen_name("nes_set_audio_rate") private func nes_set_audio_rate(_ nes: NESRef, _ sampleRate: Double)
+@_silgen_name("nes_audio_read") private func nes_audio_read(_ nes: NESRef, _ out: UnsafeMutablePointer<Float>, _ count: Int32) -> Int32
 
 final class EmulatorCore {
     private var nes: NESRef?
@@ -50,9 +52,9 @@ final class EmulatorCore {
 
     func currentFrameImage() -> CGImage? {
         guard let nes else { return nil }
-        guard let buffer = nes_framebuffer(nes) else { return nil }
-        let width = Int(nes_framebuffer_width())
-        let height = Int(nes_framebuffer_height())
+        guard let buffer = nes_output_framebuffer(nes) else { return nil }
+        let width = Int(nes_output_width(nes))
+        let height = Int(nes_output_height(nes))
         let count = width * height
         let data = Data(bytes: buffer, count: count * MemoryLayout<UInt32>.size)
         guard let provider = CGDataProvider(data: data as CFData) else { return nil }
@@ -81,6 +83,16 @@ final class EmulatorCore {
         nes_set_button(nes, button.rawValue, pressed)
     }
 
+    func setChangeTracking(_ enabled: Bool) {
+        guard let nes else { return }
+        nes_set_change_tracking(nes, enabled)
+    }
+
+    func frameUnchanged() -> Bool {
+        guard let nes else { return false }
+        return nes_frame_unchanged(nes)
+    }
+
     func makeAudioEngine() -> CAudioEngine? {
         guard let nes else { return nil }
         return CAudioEngine(nes: nes)
@@ -93,11 +105,6 @@ final class CAudioEngine {
     private var format: AVAudioFormat?
     private var sourceNode: AVAudioSourceNode?
     private var observers: [NSObjectProtocol] = []
-    private var ring = AudioRingBuffer(capacity: 88200)
-    private var sampleRate: Double = 44100
-    private var samplesPerFrame: Int = 735
-    private let audioQueue = DispatchQueue(label: "nes.audio.queue", qos: .userInitiated)
-    private var audioTimer: DispatchSourceTimer?
 
     init(nes: NESRef) {
         self.nes = nes
@@ -117,7 +124,6 @@ final class CAudioEngine {
 
     func stop() {
         engine.pause()
-        stopProducer()
     }
 
     func shutdown() {
@@ -126,7 +132,6 @@ final class CAudioEngine {
             engine.detach(node)
             sourceNode = nil
         }
-        stopProducer()
     }
 
     deinit {
@@ -163,9 +168,7 @@ final class CAudioEngine {
         let channelCount = outputFormat.channelCount > 0 ? outputFormat.channelCount : 2
         let activeFormat = AVAudioFormat(standardFormatWithSampleRate: sampleRate, channels: channelCount)!
         format = activeFormat
-        self.sampleRate = sampleRate
-        self.samplesPerFrame = max(1, Int(sampleRate / 60.0))
-        ring = AudioRingBuffer(capacity: max(4096, Int(sampleRate * 3)))
+        nes_set_audio_rate(nes, sampleRate)
 
         if sourceNode == nil {
             let source = AVAudioSourceNode { [weak self] _, _, frameCount, audioBufferList -> OSStatus in
@@ -179,7 +182,7 @@ final class CAudioEngine {
                 guard let firstData = bufferList[0].mData else { return noErr }
                 bufferList[0].mDataByteSize = UInt32(bytes)
                 let firstSamples = firstData.assumingMemoryBound(to: Float.self)
-                let read = self.ring.read(into: firstSamples, count: frameCountInt)
+                let read = Int(nes_audio_read(self.nes, firstSamples, Int32(frameCountInt)))
                 if read < frameCountInt {
                     firstSamples.advanced(by: read).initialize(repeating: 0, count: frameCountInt - read)
                 }
@@ -212,8 +215,6 @@ final class CAudioEngine {
                 }
             }
         }
-
-        startProducer()
     }
 
     private func rebuildEngine() {
@@ -223,8 +224,6 @@ final class CAudioEngine {
         }
         sourceNode = nil
         format = nil
-        ring.clear()
-        stopProducer()
         engine = AVAudioEngine()
         start(rebuildIfNeeded: false)
     }
@@ -240,124 +239,4 @@ final class CAudioEngine {
             }
         }
     }
-
-    func enqueueSamples() {
-        let count = samplesPerFrame
-        if count <= 0 {
-            return
-        }
-        let targetFill = max(count * 2, Int(sampleRate * 0.25))
-        var attempts = 0
-        while ring.availableToRead < targetFill && ring.availableToWrite >= count && attempts < 4 {
-            var temp = Array(repeating: Float(0), count: count)
-            temp.withUnsafeMutableBufferPointer { buffer in
-                guard let base = buffer.baseAddress else { return }
-                nes_apu_fill_buffer(nes, sampleRate, base, Int32(count))
-            }
-            _ = ring.write(temp, count: count)
-            attempts += 1
-        }
-    }
-
-    private func startProducer() {
-        if audioTimer != nil {
-            return
-        }
-        let timer = DispatchSource.makeTimerSource(queue: audioQueue)
-        timer.schedule(deadline: .now(), repeating: 1.0 / 240.0)
-        timer.setEventHandler { [weak self] in
-            self?.enqueueSamples()
-        }
-        audioTimer = timer
-        timer.resume()
-    }
-
-    private func stopProducer() {
-        audioTimer?.cancel()
-        audioTimer = nil
-    }
-
-}
-
-private final class AudioRingBuffer {
-    private var buffer: [Float]
-    private var readIndex = 0
-    private var writeIndex = 0
-    private var count = 0
-    private let lock = NSLock()
-
-    init(capacity: Int) {
-        buffer = Array(repeating: 0, count: max(1, capacity))
-    }
-
-    func clear() {
-        lock.lock()
-        readIndex = 0
-        writeIndex = 0
-        count = 0
-        lock.unlock()
-    }
-
-    var availableToRead: Int {
-        lock.lock()
-        let value = count
-        lock.unlock()
-        return value
-    }
-
-    var availableToWrite: Int {
-        lock.lock()
-        let value = buffer.count - count
-        lock.unlock()
-        return value
-    }
-
-    func write(_ samples: [Float], count writeCount: Int) -> Int {
-        if writeCount <= 0 {
-            return 0
-        }
-        lock.lock()
-        let capacity = buffer.count
-        let space = capacity - count
-        let toWrite = min(writeCount, space)
-        if toWrite > 0 {
-            let first = min(toWrite, capacity - writeIndex)
-            for i in 0..<first {
-                buffer[writeIndex + i] = samples[i]
-            }
-            if toWrite > first {
-                for i in 0..<(toWrite - first) {
-                    buffer[i] = samples[first + i]
-                }
-            }
-            writeIndex = (writeIndex + toWrite) % capacity
-            count += toWrite
-        }
-        lock.unlock()
-        return toWrite
-    }
-
-    func read(into out: UnsafeMutablePointer<Float>, count readCount: Int) -> Int {
-        if readCount <= 0 {
-            return 0
-        }
-        lock.lock()
-        let capacity = buffer.count
-        let toRead = min(readCount, count)
-        if toRead > 0 {
-            let first = min(toRead, capacity - readIndex)
-            for i in 0..<first {
-                out[i] = buffer[readIndex + i]
-            }
-            if toRead > first {
-                for i in 0..<(toRead - first) {
-                    out[first + i] = buffer[i]
-                }
-            }
-            readIndex = (readIndex + toRead) % capacity
-            count -= toRead
-        }
-        lock.unlock()
-        return toRead
-    }
 }
@@ -1,18 +1,24 @@
 #ifndef NESC_APU_H
 #define NESC_APU_H
 
-#include "types.hpp"
-#include <pthread.h>
+#include "audio_ring.hpp"
+#include "blip_buffer.hpp"
+#include "resampler.hpp"
 
 typedef uint8_t (*ApuReadFunc)(void *context, uint16_t addr);
 
+// Returned by ticksToChange when a channel's output cannot change until a
+// register write or frame counter step.
+#define APU_NO_EVENT INT32_MAX
+
 class PulseChannel {
 public:
     uint8_t control;
     uint16_t timer;
+    uint16_t timerCounter;
     uint8_t lengthCounter;
     bool enabled;
-    double phase;
+    uint8_t dutyPos;
     uint8_t envDivider;
     uint8_t envDecay;
     bool envStart;
@@ -33,7 +39,10 @@ public:
     void tickLength();
     void tickEnvelope();
     void tickSweep();
-    double sample(double sampleRate);
+    void tickTimer();
+    void run(int ticks);
+    int ticksToChange() const;
+    uint8_t output() const;
 
 private:
     void applySweep();
@@ -59,7 +68,9 @@ public:
     void tickLength();
     void tickLinear();
     void tickTimer();
-    double sample() const;
+    void run(int ticks);
+    int ticksToChange() const;
+    uint8_t output() const;
 };
 
 class NoiseChannel {
@@ -81,7 +92,12 @@ public:
     void tickLength();
     void tickEnvelope();
     void tickTimer();
-    double sample() const;
+    void run(int ticks);
+    int ticksToChange() const;
+    uint8_t output() const;
+
+private:
+    void shift();
 };
 
 class DmcChannel {
@@ -110,12 +126,48 @@ public:
     void setEnabled(bool value);
     void fetchSample(ApuReadFunc read, void *context);
     void tickTimer();
-    double sample() const;
+    void run(int ticks);
+    int ticksToChange() const;
+    uint8_t output() const;
 
 private:
     void restart();
 };
 
+// Building with NESC_FIXED_POINT_AUDIO runs the output filters in integer
+// arithmetic for cores without a fast FPU; samples only become floats when
+// they are handed to the ring.
+#if defined(NESC_FIXED_POINT_AUDIO)
+typedef int32_t ApuSample;
+#else
+typedef float ApuSample;
+#endif
+
+// One-pole stage of the console's analog output path. The gain is derived
+// from the cutoff whenever the output rate changes.
+struct ApuFilter {
+    ApuSample gain;
+    ApuSample input;
+    ApuSample state;
+
+    void setHighPass(double cutoff, double sampleRate);
+    void setLowPass(double cutoff, double sampleRate);
+    ApuSample highPass(ApuSample x);
+    ApuSample lowPass(ApuSample x);
+};
+
+// Channels are synthesized at a fixed oversampled rate and resampled to the
+// host rate, so the band-limited buffer never depends on the output device.
+#define APU_INTERNAL_RATE 96000.0
+#define APU_BLIP_CHUNK_CYCLES 4096
+#define APU_INTERNAL_SAMPLES 256
+#define APU_PENDING_SAMPLES 1024
+
+// Clocked from the emulation thread with the CPU cycles of each instruction.
+// Channel timers and the frame counter advance in jumps to the next cycle
+// where an output can change or a frame counter step falls; the mix at that
+// cycle goes into the band-limited buffer. Every APU_BLIP_CHUNK_CYCLES the
+// buffer is read out, resampled, filtered and handed to the audio ring.
 class APU {
 public:
     PulseChannel pulse1;
@@ -124,28 +176,47 @@ public:
     NoiseChannel noise;
     DmcChannel dmc;
     int frameCounterCycle;
+    int frameStep;
     bool frameCounterMode;
     bool frameIrqInhibit;
-    double outputFilter;
-    double sampleCycleRemainder;
-    pthread_mutex_t mutex;
+    bool oddCycle;
+    bool dirty;
+    int nextEvent;
+    NesAudioQuality quality;
+    double sampleRate;
+    ApuFilter highPass90;
+    ApuFilter highPass440;
+    ApuFilter lowPass;
+    BlipBuffer blip;
+    Resampler resampler;
+    uint32_t blipTime;
+    int amplitude;
     ApuReadFunc read;
     void *readContext;
+    AudioRing *output;
+    int internal[APU_INTERNAL_SAMPLES];
+    int mixed[APU_PENDING_SAMPLES];
+    float pending[APU_PENDING_SAMPLES];
 
     void init();
     void reset();
     void setReadCallback(ApuReadFunc readFunc, void *context);
+    void setOutput(AudioRing *ring);
+    void setSampleRate(double rate);
+    void setQuality(NesAudioQuality quality);
     void cpuWrite(uint16_t addr, uint8_t data);
     uint8_t readStatus();
     void step(int cycles);
-    float nextSample(double sample_rate);
-    void fillBuffer(double sample_rate, float *out, int count);
+    void flush();
 
 private:
     void quarterFrame();
     void halfFrame();
-    void stepCyclesUnlocked(int cycles);
-    float nextSampleUnlocked(double sample_rate);
+    void frameCounterStep();
+    void clock();
+    void advance(int cycles);
+    int cyclesToEvent() const;
+    void updateOutput();
 };
 
 #endif
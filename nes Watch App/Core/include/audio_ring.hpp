@@ -0,0 +1,31 @@
+#ifndef NESC_AUDIO_RING_H
+#define NESC_AUDIO_RING_H
+
+#include "types.hpp"
+#include <atomic>
+
+#define AUDIO_RING_CAPACITY 8192
+
+// Single-producer/single-consumer sample queue between the emulation thread,
+// which appends what the APU generated, and the audio callback, which drains
+// it. Neither side blocks: a full ring drops the newest samples and an empty
+// one returns short reads. The output rate is set from any thread and picked
+// up by the producer at the next frame.
+class AudioRing {
+public:
+    AudioRing();
+
+    void setRate(double rate);
+    double producerRate() const;
+    int write(const float *input, int count);
+    int read(float *out, int count);
+    int available() const;
+
+private:
+    alignas(NES_CACHE_LINE) std::atomic<uint32_t> head;
+    alignas(NES_CACHE_LINE) std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> rate;
+    float samples[AUDIO_RING_CAPACITY];
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef NESC_BLIP_BUFFER_H
+#define NESC_BLIP_BUFFER_H
+
+#include "types.hpp"
+
+#define BLIP_PHASE_BITS 5
+#define BLIP_PHASES (1 << BLIP_PHASE_BITS)
+#define BLIP_HALF_WIDTH 8
+#define BLIP_WIDTH (BLIP_HALF_WIDTH * 2)
+#define BLIP_DELTA_BITS 15
+#define BLIP_FRAC_BITS 32
+#define BLIP_AMPLITUDE_BITS 14
+#define BLIP_BUFFER_SIZE 1024
+
+// Band-limited step synthesis in the style of blip_buf. Callers add the
+// change in amplitude at the clock it happens; each delta is spread over
+// BLIP_WIDTH output samples by a windowed-sinc kernel picked by the
+// sub-sample phase, and reading integrates the deltas back into a waveform.
+// Amplitudes are integers where 1 << BLIP_AMPLITUDE_BITS is full scale. Times
+// are clocks since the last endFrame, and at most BLIP_BUFFER_SIZE samples
+// may be pending, so frames must be ended and read in short chunks.
+class BlipBuffer {
+public:
+    void clear();
+    void setRates(double clockRate, double sampleRate);
+    void addDelta(uint32_t time, int delta);
+    void endFrame(uint32_t time);
+    int samplesAvailable() const;
+    int readSamples(int *out, int count);
+
+private:
+    uint64_t factor;
+    uint64_t offset;
+    int integrator;
+    int buffer[BLIP_BUFFER_SIZE + BLIP_WIDTH];
+};
+
+#endif
@@ -8,16 +8,14 @@
 
 class CPU;
 
-class Bus {
+class alignas(NES_CACHE_LINE) Bus {
 public:
     CPU *cpu;
     PPU *ppu;
     APU *apu;
     Cartridge *cartridge;
+    uint8_t *prgRam;
     Controller controller;
-
-    uint8_t cpuRam[2048];
-    uint8_t prgRam[8192];
     uint8_t dataBus;
 
     bool irqPending;
@@ -29,6 +27,8 @@ public:
     int dmaCycle;
     uint8_t dmaData;
 
+    alignas(NES_CACHE_LINE) uint8_t cpuRam[2048];
+
     Bus() {
         memset(this, 0, sizeof(Bus));
     }
@@ -37,6 +37,11 @@ public:
     uint8_t cpuReadOpcode(uint16_t addr);
     void cpuWrite(uint16_t addr, uint8_t data);
 
+    template <class M>
+    uint8_t cpuReadAs(uint16_t addr);
+    template <class M>
+    void cpuWriteAs(uint16_t addr, uint8_t data);
+
     bool isIrqPending();
     void ackIrq();
     void tick(int cycles);
@@ -48,8 +53,41 @@ public:
 
 private:
     uint8_t cpuReadInternal(uint16_t addr);
+    uint8_t readSystem(uint16_t addr);
+    void writeSystem(uint16_t addr, uint8_t data);
+    void syncMirroring();
     void startDma(uint8_t page);
     void stepDma();
 };
 
+template <class M>
+inline uint8_t Bus::cpuReadAs(uint16_t addr) {
+    M *mapper = cartridge ? static_cast<M *>(cartridge->mapper.get()) : nullptr;
+    if (mapper) {
+        uint8_t cartData = 0;
+        if (mapper->cpuRead(*cartridge, addr, &cartData)) {
+            dataBus = cartData;
+            return cartData;
+        }
+    }
+    if (addr <= 0x1FFF) {
+        dataBus = cpuRam[addr & 0x07FF];
+        return dataBus;
+    }
+    return readSystem(addr);
+}
+
+template <class M>
+inline void Bus::cpuWriteAs(uint16_t addr, uint8_t data) {
+    dataBus = data;
+    M *mapper = cartridge ? static_cast<M *>(cartridge->mapper.get()) : nullptr;
+    if (mapper && mapper->cpuWrite(*cartridge, addr, data)) {
+        syncMirroring();
+        return;
+    }
+    writeSystem(addr, data);
+}
+
+static_assert(offsetof(Bus, cpuRam) == NES_CACHE_LINE, "Bus state must fit one cache line ahead of RAM");
+
 #endif
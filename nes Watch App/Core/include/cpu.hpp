@@ -50,7 +50,7 @@ typedef struct {
     uint8_t cycles;
 } Instruction;
 
-class CPU {
+class alignas(NES_CACHE_LINE) CPU {
 public:
     Bus *bus;
     uint8_t a;
@@ -65,7 +65,7 @@ public:
     uint8_t opcode;
     uint8_t baseHigh;
     int cycleCounter;
-    Instruction instructions[256];
+    const Instruction *instructions;
 
     CPU() {
         memset(this, 0, sizeof(CPU));
@@ -76,6 +76,10 @@ public:
     void irq();
     void nmi();
     int step();
+    template <class M>
+    int step();
+    template <class M>
+    void selectMapper();
     uint8_t read(uint16_t addr);
     void write(uint16_t addr, uint8_t data);
     void push(uint8_t value);
@@ -87,4 +91,6 @@ public:
     void impliedDummyRead();
 };
 
+static_assert(sizeof(CPU) == NES_CACHE_LINE, "CPU registers must fit one cache line");
+
 #endif
@@ -0,0 +1,11 @@
+#ifndef NESC_DOWNSCALE_H
+#define NESC_DOWNSCALE_H
+
+#include "types.hpp"
+
+// 2:1 reductions of ARGB scanlines. `width` is the output width; inputs hold
+// twice as many pixels.
+void downscale_box_rows(const uint32_t *top, const uint32_t *bottom, uint32_t *out, int width);
+void downscale_point_row(const uint32_t *in, uint32_t *out, int width);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef NESC_FRAME_EXCHANGE_H
+#define NESC_FRAME_EXCHANGE_H
+
+#include "types.hpp"
+#include <atomic>
+
+// Triple buffering over three caller-owned frames. The emulation thread draws
+// into the back frame and publishes it by swapping it into the shared slot;
+// the presenter takes the newest published frame by swapping its front frame
+// back in. Neither side waits on the other and a frame is never written while
+// the presenter holds it. The shared slot packs the buffer index (bits 0-1),
+// a fresh flag (bit 2) and the frame's sequence number (bits 3-63). The
+// emulation thread may read its newest published frame between frames: the
+// buffer only returns to it as a back buffer on a later publish.
+class FrameExchange {
+public:
+    FrameExchange() { attach(nullptr); }
+
+    void attach(uint32_t *const *frames);
+    bool attached() const { return buffers[0] != nullptr; }
+    FrameBuffer *backBuffer() const { return (FrameBuffer *)buffers[back]; }
+    const uint32_t *newest() const { return buffers[latest]; }
+    void publish();
+    const uint32_t *acquire(uint64_t *sequence);
+
+private:
+    uint32_t *buffers[3];
+    int back;
+    int latest;
+    uint64_t published;
+    int front;
+    uint64_t frontSequence;
+    std::atomic<uint64_t> shared;
+};
+
+#endif
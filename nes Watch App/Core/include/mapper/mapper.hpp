@@ -5,13 +5,67 @@
 
 class Cartridge;
 
+#define MAPPER_PRG_PAGE_SIZE 0x1000
+#define MAPPER_CHR_PAGE_SIZE 0x0400
+
 class Mapper {
 public:
+    // 4 KB windows over $8000-$FFFF and 1 KB windows over PPU $0000-$1FFF.
+    // Mappers rebuild these in updateBanks() whenever a bank register
+    // changes; a null page reads as unmapped.
+    const uint8_t *prgPages[8] = {};
+    uint8_t *chrPages[8] = {};
+    bool chrWritable = false;
+
     virtual ~Mapper() = default;
-    virtual bool cpuRead(Cartridge &cart, uint16_t addr, uint8_t *out) = 0;
+    virtual void updateBanks(Cartridge &cart) = 0;
+    virtual bool cpuRead(Cartridge &cart, uint16_t addr, uint8_t *out);
     virtual bool cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) = 0;
-    virtual bool ppuRead(Cartridge &cart, uint16_t addr, uint8_t *out) = 0;
-    virtual bool ppuWrite(Cartridge &cart, uint16_t addr, uint8_t data) = 0;
+    virtual bool ppuRead(Cartridge &cart, uint16_t addr, uint8_t *out);
+    virtual bool ppuWrite(Cartridge &cart, uint16_t addr, uint8_t data);
+
+protected:
+    void mapPrg(Cartridge &cart, int page, int count, uint32_t offset);
+    void mapChr(Cartridge &cart, int page, int count, uint32_t offset);
 };
 
+inline bool Mapper::cpuRead(Cartridge &cart, uint16_t addr, uint8_t *out) {
+    (void)cart;
+    if (addr < 0x8000) {
+        return false;
+    }
+    const uint8_t *page = prgPages[(addr >> 12) & 0x07];
+    if (!page) {
+        return false;
+    }
+    *out = page[addr & (MAPPER_PRG_PAGE_SIZE - 1)];
+    return true;
+}
+
+inline bool Mapper::ppuRead(Cartridge &cart, uint16_t addr, uint8_t *out) {
+    (void)cart;
+    if (addr >= 0x2000) {
+        return false;
+    }
+    const uint8_t *page = chrPages[addr >> 10];
+    if (!page) {
+        return false;
+    }
+    *out = page[addr & (MAPPER_CHR_PAGE_SIZE - 1)];
+    return true;
+}
+
+inline bool Mapper::ppuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
+    (void)cart;
+    if (!chrWritable || addr >= 0x2000) {
+        return false;
+    }
+    uint8_t *page = chrPages[addr >> 10];
+    if (!page) {
+        return false;
+    }
+    page[addr & (MAPPER_CHR_PAGE_SIZE - 1)] = data;
+    return true;
+}
+
 #endif
@@ -0,0 +1,16 @@
+#ifndef NESC_MAPPER_LIST_H
+#define NESC_MAPPER_LIST_H
+
+#include "cnrom.hpp"
+#include "mmc1.hpp"
+#include "nrom.hpp"
+
+// Every concrete mapper with its iNES id. The hot CPU/PPU loop is instantiated
+// once per entry so cartridge reads bind to the final class and inline; the
+// virtual Mapper interface stays as the generic fallback.
+#define NESC_MAPPER_LIST(X) \
+    X(0, NromMapper)        \
+    X(1, Mmc1Mapper)        \
+    X(3, CnromMapper)
+
+#endif
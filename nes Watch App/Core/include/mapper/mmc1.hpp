@@ -3,7 +3,7 @@
 
 #include "mapper.hpp"
 
-class Mmc1Mapper : public Mapper {
+class Mmc1Mapper final : public Mapper {
 public:
     uint8_t shiftReg = 0x10;
     uint8_t shiftCount = 0;
@@ -12,10 +12,8 @@ public:
     uint8_t chrBank1 = 0;
     uint8_t prgBank = 0;
 
-    bool cpuRead(Cartridge &cart, uint16_t addr, uint8_t *out) override;
+    void updateBanks(Cartridge &cart) override;
     bool cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) override;
-    bool ppuRead(Cartridge &cart, uint16_t addr, uint8_t *out) override;
-    bool ppuWrite(Cartridge &cart, uint16_t addr, uint8_t data) override;
 
 private:
     void applyControl(Cartridge &cart, uint8_t value);
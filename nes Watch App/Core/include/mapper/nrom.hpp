@@ -3,17 +3,15 @@
 
 #include "mapper.hpp"
 
-class NromMapper : public Mapper {
+class NromMapper final : public Mapper {
 public:
     int prgBanks;
     int chrBanks;
 
     explicit NromMapper(int prg, int chr) : prgBanks(prg), chrBanks(chr) {}
 
-    bool cpuRead(Cartridge &cart, uint16_t addr, uint8_t *out) override;
+    void updateBanks(Cartridge &cart) override;
     bool cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) override;
-    bool ppuRead(Cartridge &cart, uint16_t addr, uint8_t *out) override;
-    bool ppuWrite(Cartridge &cart, uint16_t addr, uint8_t data) override;
 };
 
 #endif
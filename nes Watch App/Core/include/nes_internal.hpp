@@ -5,22 +5,296 @@
 #include "bus.hpp"
 #include "cartridge.hpp"
 #include "cpu.hpp"
+#include "frame_exchange.hpp"
+#include "mapper/mapper_list.hpp"
+#include "policy.hpp"
 #include "ppu.hpp"
+#include "render_pipeline.hpp"
+#include <type_traits>
 
-class NES {
+struct NoFrameBuffer {};
+struct NoRenderer {};
+struct NoAudio {};
+
+// Buffers that are only touched in bulk or rarely. They live behind
+// pointers so the per-instruction state above them stays packed.
+struct MachineMemory {
+    alignas(NES_CACHE_LINE) uint8_t prgRam[8192];
+    alignas(NES_CACHE_LINE) uint8_t nametableRam[4096];
+    ScanlineMemory scanlines;
+};
+
+// Caches only the drawing paths read; builds that never draw leave them out.
+struct RenderMemory {
+    PatternCache patterns;
+    BackgroundPlane plane;
+};
+
+template <class Config>
+class Machine {
 public:
-    Bus bus;
+    typedef typename Config::Audio Audio;
+    typedef typename Config::Render Render;
+    typedef typename Config::Trace Trace;
+    typedef typename Config::Accuracy Accuracy;
+
+    // Hot state first: CPU registers, PPU registers and OAM, bus state and
+    // the zero page/stack at the start of cpuRam share adjacent lines.
     CPU cpu;
     PPU ppu;
-    APU apu;
+    Bus bus;
+    [[no_unique_address]] std::conditional_t<Audio::enabled, APU, NoAudio> apu;
     Cartridge cart;
     bool hasCart;
+    [[no_unique_address]] Trace trace;
+    MachineMemory memory;
+    [[no_unique_address]] std::conditional_t<Render::enabled, RenderMemory, NoRenderer> renderMemory;
+    [[no_unique_address]] std::conditional_t<Render::enabled, FrameBuffer, NoFrameBuffer> frameBuffer;
+    [[no_unique_address]] std::conditional_t<Render::enabled, IndexedFrameBuffer, NoFrameBuffer> indexedFrame;
+    [[no_unique_address]] std::conditional_t<Render::enabled, ScaledFrameBuffer, NoFrameBuffer> scaledFrame;
+    [[no_unique_address]] std::conditional_t<Render::enabled, FrameDiff, NoFrameBuffer> frameDiff;
+    [[no_unique_address]] std::conditional_t<Render::enabled, FrameExchange, NoRenderer> frames;
+    [[no_unique_address]] std::conditional_t<Render::enabled, RenderPipeline, NoRenderer> pipeline;
+    [[no_unique_address]] std::conditional_t<Audio::enabled, AudioRing, NoAudio> audio;
+
+    Machine();
+    ~Machine();
+    Machine(const Machine &) = delete;
+    Machine &operator=(const Machine &) = delete;
 
-    NES();
-    ~NES();
     bool loadRom(const uint8_t *data, size_t size);
     void reset();
-    void stepFrame();
+    void stepFrame(bool draw = true);
+    void setFrameBuffers(uint32_t *const *buffers);
+    void setPipelined(bool enabled);
+    void setPpuMode(NesPpuMode mode);
+
+private:
+    typedef void (Machine::*FrameRunner)();
+
+    FrameRunner runner;
+    FrameRunner skipRunner;
+    bool pipelined;
+    NesPpuMode ppuMode;
+
+    template <class M, bool Draw, bool Dot>
+    void runFrame();
+    void selectRunner();
+    template <class M>
+    void useMapper();
+
+    static uint8_t busRead(void *context, uint16_t addr) {
+        return ((Bus *)context)->cpuRead(addr);
+    }
 };
 
+template <class Config>
+Machine<Config>::Machine()
+    : hasCart(false),
+      runner(&Machine::runFrame<Mapper, true, false>),
+      skipRunner(&Machine::runFrame<Mapper, false, false>),
+      pipelined(false),
+      ppuMode(NES_PPU_SCANLINE) {
+    memset(&memory, 0, sizeof(memory));
+    bus.cpu = &cpu;
+    bus.ppu = &ppu;
+    bus.prgRam = memory.prgRam;
+    if constexpr (Render::enabled) {
+        memset(&renderMemory, 0, sizeof(renderMemory));
+        ppu.attachMemory(memory.nametableRam, &memory.scanlines, &renderMemory.patterns, &renderMemory.plane);
+    } else {
+        ppu.attachMemory(memory.nametableRam, &memory.scanlines, nullptr, nullptr);
+    }
+    cpu.init();
+    cpu.bus = &bus;
+    if constexpr (Audio::enabled) {
+        apu.init();
+        bus.apu = &apu;
+        apu.setReadCallback(busRead, &bus);
+        apu.setOutput(&audio);
+    }
+    if constexpr (Render::enabled) {
+        memset(&frameBuffer, 0, sizeof(frameBuffer));
+        memset(&indexedFrame, 0, sizeof(indexedFrame));
+        memset(&scaledFrame, 0, sizeof(scaledFrame));
+        memset(&frameDiff, 0, sizeof(frameDiff));
+        ppu.frameBuffer = &frameBuffer;
+        ppu.indexedFrame = &indexedFrame;
+        ppu.scaledFrame = &scaledFrame;
+        ppu.changes = &frameDiff;
+    }
+}
+
+template <class Config>
+Machine<Config>::~Machine() {
+    if constexpr (Render::enabled) {
+        pipeline.stop();
+    }
+    cart.free();
+}
+
+template <class Config>
+bool Machine<Config>::loadRom(const uint8_t *data, size_t size) {
+    hasCart = false;
+    if constexpr (Render::enabled) {
+        pipeline.stop();
+    }
+    cart.free();
+    if (!cart.load(data, size)) {
+        cart.free();
+        return false;
+    }
+    bus.cartridge = &cart;
+    ppu.connectCartridge(&cart);
+    ppu.setDotRender(ppuMode == NES_PPU_DOT);
+    selectRunner();
+    hasCart = true;
+    reset();
+    if constexpr (Render::enabled) {
+        if (pipelined && !ppu.dotRender) {
+            pipeline.start(ppu, cart);
+        }
+    }
+    return true;
+}
+
+template <class Config>
+void Machine<Config>::reset() {
+    if constexpr (Audio::enabled) {
+        apu.reset();
+    }
+    cpu.reset();
+}
+
+// Registered buffers replace the internal full-size frame. Each drawn
+// full-size ARGB frame is published as it completes and the PPU moves on to
+// the next back buffer; indexed and scaled frames go to their own buffers and
+// publish nothing.
+template <class Config>
+void Machine<Config>::setFrameBuffers(uint32_t *const *buffers) {
+    if constexpr (Render::enabled) {
+        frames.attach(buffers);
+        ppu.frameBuffer = frames.attached() ? frames.backBuffer() : &frameBuffer;
+    }
+}
+
+// Call between frames. The worker thread is started from the current PPU state
+// and stopped again whenever the cartridge changes.
+template <class Config>
+void Machine<Config>::setPipelined(bool enabled) {
+    if constexpr (Render::enabled) {
+        pipelined = enabled;
+        if (!enabled) {
+            pipeline.stop();
+        } else if (hasCart && !ppu.dotRender && !pipeline.running()) {
+            pipeline.start(ppu, cart);
+        }
+    }
+}
+
+// The PPU mode is a property of the loaded game; a change is picked up by the
+// next loadRom, which selects the matching frame runners.
+template <class Config>
+void Machine<Config>::setPpuMode(NesPpuMode mode) {
+    ppuMode = mode;
+}
+
+template <class Config>
+void Machine<Config>::selectRunner() {
+    switch (cart.mapperID) {
+#define NESC_SELECT_RUNNER(id, Type) \
+    case id:                         \
+        useMapper<Type>();           \
+        return;
+        NESC_MAPPER_LIST(NESC_SELECT_RUNNER)
+#undef NESC_SELECT_RUNNER
+        default:
+            useMapper<Mapper>();
+            return;
+    }
+}
+
+template <class Config>
+template <class M>
+void Machine<Config>::useMapper() {
+    cpu.template selectMapper<M>();
+    if (ppu.dotRender) {
+        runner = &Machine::template runFrame<M, true, true>;
+        skipRunner = &Machine::template runFrame<M, false, true>;
+    } else {
+        runner = &Machine::template runFrame<M, true, false>;
+        skipRunner = &Machine::template runFrame<M, false, false>;
+    }
+}
+
+// A skipped frame runs the same CPU/PPU timing, including vblank, NMI and
+// sprite-0 hit, but leaves the frame buffer holding the last drawn frame.
+template <class Config>
+void Machine<Config>::stepFrame(bool draw) {
+    if (!hasCart) {
+        return;
+    }
+    (this->*(draw ? runner : skipRunner))();
+}
+
+template <class Config>
+template <class M, bool Draw, bool Dot>
+void Machine<Config>::runFrame() {
+    constexpr bool Raster = Draw && Render::enabled;
+    // Only the dot renderer reads CHR through the mapper; the scanline path
+    // goes through page pointers and shares one instantiation.
+    typedef std::conditional_t<Dot, M, Mapper> PpuMapper;
+    ppu.resetFrame();
+    if constexpr (Audio::enabled) {
+        apu.setSampleRate(audio.producerRate());
+    }
+    if constexpr (Render::enabled) {
+        if (ppu.pipeline) {
+            pipeline.beginFrame();
+        }
+    }
+    while (!ppu.frameComplete) {
+        if constexpr (Trace::enabled) {
+            if (bus.stallCycles == 0) {
+                trace.instruction(cpu);
+            }
+        }
+        int cycles = cpu.template step<M>();
+        if (cycles <= 0) {
+            continue;
+        }
+        if constexpr (Audio::enabled) {
+            apu.step(cycles);
+        }
+        if constexpr (Accuracy::batchPpu) {
+            if (ppu.template run<Raster, PpuMapper, Dot>(cycles * 3)) {
+                cpu.nmi();
+            }
+        } else {
+            for (int i = 0; i < cycles * 3; i++) {
+                ppu.template tick<Raster, PpuMapper, Dot>();
+                if (ppu.nmiRequested) {
+                    cpu.nmi();
+                }
+            }
+        }
+    }
+    if constexpr (Render::enabled) {
+        if (ppu.pipeline) {
+            pipeline.finishFrame();
+        }
+    }
+    if constexpr (Audio::enabled) {
+        apu.flush();
+    }
+    if constexpr (Raster) {
+        if (frames.attached() && ppu.fullFrameOutput()) {
+            frames.publish();
+            ppu.frameBuffer = frames.backBuffer();
+        }
+    }
+}
+
+class NES : public Machine<DefaultConfig> {};
+
 #endif
@@ -16,15 +16,78 @@ void nes_destroy(NESRef nes);
 bool nes_load_rom(NESRef nes, const uint8_t *data, size_t size);
 void nes_reset(NESRef nes);
 void nes_step_frame(NESRef nes);
+void nes_skip_frame(NESRef nes);
 
+// The newest full-size ARGB frame: the internal frame, or with triple
+// buffering the buffer last published.
 const uint32_t *nes_framebuffer(NESRef nes);
 int nes_framebuffer_width(void);
 int nes_framebuffer_height(void);
 
+// Triple buffering: pass three 256x240 ARGB buffers (or NULL to go back to the
+// internal frame) before emulation starts. nes_acquire_frame may then be
+// called from another thread; it returns the newest finished frame, which is
+// left alone until the next acquire, and its sequence number. Only full-size
+// ARGB frames are published: with indexed or scaled output enabled the
+// buffers are not written and the sequence stops advancing.
+void nes_set_frame_buffers(NESRef nes, uint32_t *const *buffers);
+const uint32_t *nes_acquire_frame(NESRef nes, uint64_t *sequence);
+
+// Indexed output writes one 6-bit palette index per pixel plus the emphasis
+// bits of each line instead of ARGB; convert with nes_convert_frame.
+void nes_set_indexed_output(NESRef nes, bool enabled);
+const uint8_t *nes_framebuffer_indexed(NESRef nes);
+const uint8_t *nes_framebuffer_emphasis(NESRef nes);
+int nes_pixel_format_size(NesPixelFormat format);
+void nes_convert_frame(NESRef nes, NesPixelFormat format, void *out, int stride);
+
+// Decodes the indexed frame through a simulated composite signal into a
+// NES_NTSC_WIDTH x 240 ARGB image, with the colour fringing and blending of a
+// real TV. Requires indexed output.
+void nes_filter_frame_ntsc(NESRef nes, uint32_t *out, int stride);
+
+// Scaled output rasterises straight into a smaller ARGB frame; the output_*
+// calls describe whichever ARGB frame is currently being produced.
+void nes_set_output_scale(NESRef nes, NesOutputScale scale, bool crop_overscan);
+const uint32_t *nes_output_framebuffer(NESRef nes);
+int nes_output_width(NESRef nes);
+int nes_output_height(NESRef nes);
+
+// Calls `func` on the emulation thread each time `band_rows` output rows of a
+// drawn frame are finished. Pass NULL to stop.
+void nes_set_band_callback(NESRef nes, NesBandFunc func, void *context, int band_rows);
+
+// Change tracking reports which 8x8 blocks of the current output differ from
+// the previous frame: one word per block row (nes_output_height / 8 rows), bit
+// c for columns 8c to 8c+7. A skipped frame reports no changes. Without
+// tracking every frame counts as changed.
+void nes_set_change_tracking(NESRef nes, bool enabled);
+bool nes_frame_unchanged(NESRef nes);
+const uint32_t *nes_frame_dirty_blocks(NESRef nes);
+
+// Rasterises on a worker thread that trails the CPU by a few scanlines; output
+// is identical to the serial renderer and complete when nes_step_frame
+// returns. Band callbacks then run on the worker thread.
+void nes_set_pipelined_render(NESRef nes, bool enabled);
+
+// Chooses the PPU implementation for the next nes_load_rom. The dot renderer
+// is slower but exact for mid-scanline effects; it never runs pipelined.
+void nes_set_ppu_mode(NESRef nes, NesPpuMode mode);
+
 void nes_set_button(NESRef nes, uint8_t button, bool pressed);
+void nes_set_sprite_limit(NESRef nes, bool enabled);
+void nes_set_background_plane(NESRef nes, bool enabled);
+
+// Audio is generated while frames run and queued in a lock-free ring. One
+// consumer thread, normally the audio callback, drains it with
+// nes_audio_read, which never blocks and returns the number of samples
+// copied. The rate may be changed from any thread.
+void nes_set_audio_rate(NESRef nes, double sample_rate);
+int nes_audio_read(NESRef nes, float *out, int count);
+int nes_audio_available(NESRef nes);
 
-float nes_apu_next_sample(NESRef nes, double sample_rate);
-void nes_apu_fill_buffer(NESRef nes, double sample_rate, float *out, int count);
+// Trades resampling cost for quality; call it between frames.
+void nes_set_audio_quality(NESRef nes, NesAudioQuality quality);
 
 #ifdef __cplusplus
 }
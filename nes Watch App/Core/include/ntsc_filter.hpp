@@ -0,0 +1,9 @@
+#ifndef NESC_NTSC_FILTER_H
+#define NESC_NTSC_FILTER_H
+
+#include "types.hpp"
+
+void ntsc_filter_row(const uint8_t *indices, uint8_t emphasis, int phase, uint32_t *out);
+void ntsc_filter_frame(const IndexedFrameBuffer *frame, uint32_t *out, int stride);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef NESC_PATTERN_CACHE_H
+#define NESC_PATTERN_CACHE_H
+
+#include "types.hpp"
+
+// Decoded copies of the 512 tiles currently mapped into PPU $0000-$1FFF.
+// Each tile is stored as 8 rows of 8 two-bit colour indices, once as-is and
+// once mirrored horizontally for sprites. A 1 KB slot is dropped when the
+// mapper points it at a different CHR bank, and single tiles are dropped
+// when CHR-RAM is written.
+class PatternCache {
+public:
+    void reset();
+    const uint8_t *row(uint8_t *const *chrPages, uint16_t addr, bool flip);
+    void invalidate(uint8_t *const *chrPages, uint16_t addr);
+
+private:
+    const uint8_t *sources[8];
+    uint64_t valid[8];
+    alignas(NES_CACHE_LINE) uint8_t tiles[512][2][64];
+
+    void decode(int tile, const uint8_t *planes);
+};
+
+inline const uint8_t *PatternCache::row(uint8_t *const *chrPages, uint16_t addr, bool flip) {
+    int slot = (addr >> 10) & 0x07;
+    int tile = (addr >> 4) & 0x1FF;
+    uint64_t bit = 1ULL << (tile & 0x3F);
+    if (sources[slot] != chrPages[slot]) {
+        sources[slot] = chrPages[slot];
+        valid[slot] = 0;
+    }
+    if ((valid[slot] & bit) == 0) {
+        const uint8_t *page = chrPages[slot];
+        decode(tile, page ? page + ((tile & 0x3F) << 4) : nullptr);
+        valid[slot] |= bit;
+    }
+    return tiles[tile][flip ? 1 : 0] + (addr & 0x07) * 8;
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef NESC_PIXEL_FORMAT_H
+#define NESC_PIXEL_FORMAT_H
+
+#include "types.hpp"
+
+uint32_t palette_argb(uint8_t index, uint8_t emphasis);
+int pixel_format_size(NesPixelFormat format);
+void convert_indexed_row(const uint8_t *indices, uint8_t emphasis, NesPixelFormat format, void *out, int width);
+void convert_indexed_frame(const IndexedFrameBuffer *frame, NesPixelFormat format, void *out, int stride);
+
+#endif
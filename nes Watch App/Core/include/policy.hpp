@@ -0,0 +1,88 @@
+#ifndef NESC_POLICY_H
+#define NESC_POLICY_H
+
+#include "cpu.hpp"
+
+// Compile-time switches for a Machine build. Each policy is a small type whose
+// `enabled` constant is tested with `if constexpr`, so a disabled feature is
+// compiled out of the frame loop instead of being skipped at runtime.
+
+struct AudioOn {
+    static constexpr bool enabled = true;
+};
+
+struct AudioOff {
+    static constexpr bool enabled = false;
+};
+
+struct RenderFull {
+    static constexpr bool enabled = true;
+};
+
+struct RenderSkip {
+    static constexpr bool enabled = false;
+};
+
+typedef struct {
+    uint16_t pc;
+    uint8_t a;
+    uint8_t x;
+    uint8_t y;
+    uint8_t sp;
+    uint8_t status;
+    int cycle;
+} TraceEntry;
+
+typedef void (*TraceFunc)(void *context, const TraceEntry *entry);
+
+struct TraceOff {
+    static constexpr bool enabled = false;
+
+    void instruction(const CPU &cpu) { (void)cpu; }
+};
+
+struct TraceOn {
+    static constexpr bool enabled = true;
+
+    TraceFunc func = nullptr;
+    void *context = nullptr;
+
+    void instruction(const CPU &cpu) {
+        if (!func) {
+            return;
+        }
+        TraceEntry entry;
+        entry.pc = cpu.pc;
+        entry.a = cpu.a;
+        entry.x = cpu.x;
+        entry.y = cpu.y;
+        entry.sp = cpu.sp;
+        entry.status = cpu.status;
+        entry.cycle = cpu.cycleCounter;
+        func(context, &entry);
+    }
+};
+
+// Standard ticks the PPU one dot at a time between CPU instructions and polls
+// NMI after every dot. Fast catches the PPU up once per instruction, which is
+// equivalent for the scanline renderer and avoids the per-dot call overhead.
+struct AccuracyStandard {
+    static constexpr bool batchPpu = false;
+};
+
+struct AccuracyFast {
+    static constexpr bool batchPpu = true;
+};
+
+template <class AudioPolicy, class RenderPolicy, class TracePolicy, class AccuracyPolicy>
+struct MachineConfig {
+    typedef AudioPolicy Audio;
+    typedef RenderPolicy Render;
+    typedef TracePolicy Trace;
+    typedef AccuracyPolicy Accuracy;
+};
+
+typedef MachineConfig<AudioOn, RenderFull, TraceOff, AccuracyStandard> DefaultConfig;
+typedef MachineConfig<AudioOff, RenderSkip, TraceOff, AccuracyFast> HeadlessConfig;
+
+#endif
@@ -2,52 +2,264 @@
 #define NESC_PPU_H
 
 #include "cartridge.hpp"
+#include "pattern_cache.hpp"
 #include <string.h>
 
-class PPU {
+class RenderPipeline;
+
+typedef enum {
+    PPU_LOG_CTRL,
+    PPU_LOG_MASK,
+    PPU_LOG_SCROLL_X,
+    PPU_LOG_SCROLL_Y,
+    PPU_LOG_ADDR_HIGH,
+    PPU_LOG_ADDR_LOW,
+    PPU_LOG_PALETTE
+} PpuLogRegister;
+
+typedef struct {
+    uint16_t scanline;
+    uint16_t dot;
+    uint8_t reg;
+    uint8_t value;
+    uint8_t index;
+} PpuLogEntry;
+
+#define PPU_LOG_CAPACITY 512
+
+// Register state as the renderer sees it. CPU writes are logged with the dot
+// they happened on and replayed into this copy while a scanline is drawn,
+// using the loopy temporary address to resolve $2005/$2006 scroll splits.
+typedef struct {
+    uint8_t ctrl;
+    uint8_t mask;
+    uint8_t fineX;
+    uint8_t originNTY;
+    uint16_t tempAddr;
+    uint16_t originX;
+    uint16_t originY;
+    int16_t originLine;
+    uint8_t palette[32];
+} RenderState;
+
+// State of the dot renderer beyond the loopy registers, which live in the PPU
+// (v in vramAddr, t and x in the render state). Sprite slots hold the rows
+// fetched during dots 257-320 for the following line, already unflipped.
+typedef struct {
+    uint16_t patternLow;
+    uint16_t patternHigh;
+    uint16_t attributeLow;
+    uint16_t attributeHigh;
+    uint8_t nextTile;
+    uint8_t nextAttribute;
+    uint8_t nextLow;
+    uint8_t nextHigh;
+    uint8_t spriteCount;
+    bool spriteZeroOnLine;
+    bool oddFrame;
+    uint8_t secondary[32];
+    uint8_t spriteLow[8];
+    uint8_t spriteHigh[8];
+    uint8_t spriteAttribute[8];
+    uint8_t spriteX[8];
+} DotRenderState;
+
+// Scanline working memory for the compositor. The background pass leaves the
+// colour index of each pixel in `background` for the sprite pass, and OAM is
+// bucketed into per-scanline lists ordered front to back.
+struct ScanlineMemory {
+    alignas(NES_CACHE_LINE) uint8_t background[NES_WIDTH];
+    alignas(NES_CACHE_LINE) uint8_t spriteOwner[NES_WIDTH];
+    alignas(NES_CACHE_LINE) uint32_t scaleLines[2][NES_WIDTH];
+    uint8_t spriteCount[NES_HEIGHT];
+    uint8_t spriteList[NES_HEIGHT][64];
+    uint8_t patternRow[8];
+    int logCount;
+    PpuLogEntry log[PPU_LOG_CAPACITY];
+    DotRenderState dot;
+};
+
+// Indexed copy of all four logical nametables, 512x480, one byte per pixel
+// holding palette << 2 | colour. Cells are re-rasterised only when their
+// nametable entry, attribute or pattern data changes, so a static screen
+// costs a scroll-offset copy per scanline.
+struct BackgroundPlane {
+    alignas(NES_CACHE_LINE) uint8_t pixels[480][512];
+    uint64_t dirtyCells[60];
+    uint64_t changedTiles[4];
+    const uint8_t *chrSources[4];
+    uint16_t patternBase;
+    bool dirty;
+    bool tilesChanged;
+};
+
+class alignas(NES_CACHE_LINE) PPU {
+    friend class RenderPipeline;
+
 public:
-    FrameBuffer frameBuffer;
-    Cartridge *cartridge;
-    Mirroring mirroring;
-    uint8_t dataBus;
     uint8_t ctrl;
     uint8_t mask;
     uint8_t status;
     uint8_t oamAddr;
-    uint8_t oam[256];
-    uint8_t bgColorIndex[NES_WIDTH * NES_HEIGHT];
-    uint8_t scrollX;
-    uint8_t scrollY;
-    bool addressLatch;
-    uint16_t vramAddr;
+    uint8_t dataBus;
     uint8_t readBuffer;
-    int cycle;
-    int scanline;
+    uint16_t vramAddr;
+    bool addressLatch;
     bool frameComplete;
     bool nmiRequested;
-    uint8_t nametableRam[2048];
+    bool spriteLimit;
+    bool spritesDirty;
+    bool planeEnabled;
+    bool indexedOutput;
+    bool dotRender;
+    int cycle;
+    int scanline;
+    Mirroring mirroring;
+    int spriteZeroDot;
+    Cartridge *cartridge;
+    FrameBuffer *frameBuffer;
+    PatternCache *patterns;
+    ScanlineMemory *lines;
+    uint8_t *nametablePages[4];
     uint8_t paletteRam[32];
+    alignas(NES_CACHE_LINE) uint8_t oam[256];
+    alignas(NES_CACHE_LINE) uint32_t paletteColors[32];
+    RenderState render;
+    uint8_t paletteIndices[32];
+    uint8_t outputScale;
+    uint8_t spriteListHeight;
+    bool cropOverscan;
+    bool trackChanges;
+    uint8_t *nametableRam;
+    BackgroundPlane *plane;
+    IndexedFrameBuffer *indexedFrame;
+    ScaledFrameBuffer *scaledFrame;
+    FrameDiff *changes;
+    NesBandFunc bandFunc;
+    void *bandContext;
+    int bandLines;
+    int bandStart;
+    uint8_t *const *chrPages;
+    RenderPipeline *pipeline;
 
     PPU() {
         memset(this, 0, sizeof(PPU));
+        spriteZeroDot = -1;
+        refreshPalette();
     }
 
+    void attachMemory(uint8_t *nametables, ScanlineMemory *scanlines, PatternCache *patternCache,
+                      BackgroundPlane *backgroundPlane);
     void connectCartridge(Cartridge *cart);
+    void setMirroring(Mirroring mode);
+    void setBackgroundPlane(bool enabled);
+    void setDotRender(bool enabled);
+    void setIndexedOutput(bool enabled);
+    void setOutputScale(NesOutputScale scale, bool crop);
+    void setBandCallback(NesBandFunc func, void *context, int bandRows);
+    void setChangeTracking(bool enabled);
+    bool frameUnchanged() const;
+    bool fullFrameOutput() const;
+    int outputWidth() const;
+    int outputHeight() const;
     void resetFrame();
     uint8_t cpuRead(uint16_t addr);
     void cpuWrite(uint16_t addr, uint8_t data);
+    template <bool Render = true, class M = Mapper, bool Dot = false>
     void tick();
+    template <bool Render = true, class M = Mapper, bool Dot = false>
+    bool run(int dots);
     void dmaWriteOam(uint8_t data);
 
 private:
+    template <class M = Mapper>
     uint8_t readMemory(uint16_t addr);
     void writeMemory(uint16_t addr, uint8_t data);
-    int mirrorNametable(uint16_t addr);
+    void writeNametable(uint16_t addr, uint8_t data);
+    void patternWritten(uint16_t addr);
     int mirrorPalette(uint16_t addr);
-    uint32_t paletteColor(int palette, int color);
-    uint32_t spritePaletteColor(int palette, int color);
-    void renderBackgroundScanline(int y);
-    void renderSpritesScanline(int y);
+    uint8_t resolveIndex(uint8_t value) const;
+    void refreshPalette();
+    void setPaletteEntry(int index, uint8_t value);
+    template <class Pixel>
+    Pixel *outputRow(int y);
+    template <class Pixel>
+    const Pixel *outputPalette() const;
+    void logWrite(uint8_t reg, uint8_t value, uint8_t index = 0);
+    void appendLog(const PpuLogEntry &entry);
+    bool applyLogEntry(const PpuLogEntry &entry);
+    void applyPendingLog();
+    uint16_t horizontalOrigin() const;
+    int planeRow(int y) const;
+    void startScanline(int y);
+    void beginScanline(int y);
+    template <bool Render>
+    void finishScanline(int y);
+    template <bool Render, class Pixel>
+    void replayScanline(int y);
+    void finishScaledScanline(int y);
+    void reduceScaledRow(int y);
+    void completeRow(int y);
+    void deliverRows(int rowsDone);
+    void hashRow(int row, const uint8_t *pixels, int columns, int blockBytes, uint64_t seed);
+    uint8_t backgroundIndexAt(int y, int x);
+    void evaluateSpriteZero(int y);
+    void evaluateSpriteOverflow(int y);
+    void markPlane();
+    void markPlaneNametable(int quadrant, int offset);
+    void markPlaneTile(uint16_t addr);
+    bool refreshPlane(int y);
+    void rasterizePlaneCell(int row, int column);
+    template <class Pixel>
+    void renderBackgroundSegment(int y, int x0, int x1);
+    template <class Pixel>
+    bool renderPlaneSegment(int y, int x0, int x1);
+    template <class Pixel>
+    void renderTileSegment(int y, int x0, int x1);
+    void bucketSprites(int spriteHeight);
+    const uint8_t *patternRow(uint16_t addr, bool flip);
+    const uint8_t *spriteRow(int y, int sprite, uint8_t spriteCtrl);
+    template <class Pixel>
+    void renderSpritesScanline(int y, uint8_t lineCtrl, uint8_t lineMask, const Pixel *spriteColors);
+    void advanceVramAddr();
+    template <bool Render, class M>
+    void stepDot();
+    template <class M>
+    void fetchBackgroundDot();
+    template <class M>
+    void fetchSpriteDot();
+    void loadBackgroundShifters();
+    void incrementScrollX();
+    void incrementScrollY();
+    void evaluateSprites(int y);
+    void composeDot(int x);
+    template <bool Render>
+    void finishDotScanline(int y);
+    template <class Pixel>
+    void emitDotLine(int y);
 };
 
+template <class M>
+inline uint8_t PPU::readMemory(uint16_t addr) {
+    uint16_t address = addr & 0x3FFF;
+    if (address < 0x2000) {
+        uint8_t value = 0;
+        M *mapper = cartridge ? static_cast<M *>(cartridge->mapper.get()) : nullptr;
+        if (mapper && mapper->ppuRead(*cartridge, address, &value)) {
+            return value;
+        }
+        return 0;
+    }
+    if (address < 0x3F00) {
+        return nametablePages[(address >> 10) & 0x03][address & 0x03FF];
+    }
+    int paletteIndex = mirrorPalette(address);
+    return paletteRam[paletteIndex];
+}
+
+static_assert(offsetof(PPU, nametablePages) == NES_CACHE_LINE, "PPU registers must fit the first cache line");
+static_assert(offsetof(PPU, oam) == 2 * NES_CACHE_LINE, "PPU OAM must follow the register lines");
+static_assert(offsetof(PPU, paletteColors) == 6 * NES_CACHE_LINE, "PPU palette cache must follow OAM");
+static_assert(sizeof(PPU) == 11 * NES_CACHE_LINE, "PPU must stay free of bulky buffers");
+
 #endif
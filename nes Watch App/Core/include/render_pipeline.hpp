@@ -0,0 +1,94 @@
+#ifndef NESC_RENDER_PIPELINE_H
+#define NESC_RENDER_PIPELINE_H
+
+#include "ppu.hpp"
+#include <atomic>
+#include <thread>
+
+typedef enum {
+    RENDER_CMD_LOG,
+    RENDER_CMD_OAM,
+    RENDER_CMD_NAMETABLE,
+    RENDER_CMD_CHR_WRITE,
+    RENDER_CMD_CHR_PAGE,
+    RENDER_CMD_MIRRORING,
+    RENDER_CMD_LINE_START,
+    RENDER_CMD_LINE_FINISH,
+    RENDER_CMD_FRAME_END,
+    RENDER_CMD_STOP
+} RenderCommandType;
+
+// One PPU-side event, in emulation order. `addr` holds the scanline for log
+// and line commands, the VRAM address for writes and the 1 KB CHR page for
+// bank changes.
+typedef struct {
+    uint8_t type;
+    uint8_t value;
+    uint8_t reg;
+    uint8_t index;
+    uint16_t addr;
+    uint16_t dot;
+} RenderCommand;
+
+#define RENDER_RING_CAPACITY 8192
+
+struct PipelineMemory {
+    alignas(NES_CACHE_LINE) uint8_t nametableRam[4096];
+    ScanlineMemory scanlines;
+    PatternCache patterns;
+    BackgroundPlane plane;
+    uint8_t *chrPages[8];
+    RenderCommand ring[RENDER_RING_CAPACITY];
+};
+
+// Draws frames on a worker thread. The emulation-side PPU keeps running its
+// register replay (needed for sprite 0 and scroll) but no longer rasterises;
+// every write that affects rendering is forwarded through a single-producer
+// ring to a second PPU that owns copies of VRAM, OAM, CHR-RAM and the bank
+// mapping, and which replays them in the same order with the same code. The
+// worker therefore produces exactly the serial output, a few scanlines behind
+// the CPU. The emulation thread waits for it only at the end of each frame.
+class RenderPipeline {
+public:
+    RenderPipeline() : memory(nullptr), chrRam(nullptr), source(nullptr) {}
+    ~RenderPipeline() { stop(); }
+    RenderPipeline(const RenderPipeline &) = delete;
+    RenderPipeline &operator=(const RenderPipeline &) = delete;
+
+    bool running() const { return source != nullptr; }
+    bool start(PPU &ppu, const Cartridge &cart);
+    void stop();
+    void beginFrame();
+    void finishFrame();
+
+    void log(const PpuLogEntry &entry);
+    void oam(uint8_t addr, uint8_t data);
+    void nametable(uint16_t addr, uint8_t data);
+    void chrWrite(uint16_t addr, uint8_t data, uint8_t *const *pages);
+    void mirroring(Mirroring mode);
+    void lineStart(int y, uint8_t *const *pages);
+    void lineFinish(int y, bool draw, uint8_t *const *pages);
+
+private:
+    void push(const RenderCommand &command);
+    void syncPages(uint8_t *const *pages);
+    uint8_t *translatePage(const uint8_t *page) const;
+    void workerLoop();
+    void execute(const RenderCommand &command);
+
+    PPU worker;
+    PipelineMemory *memory;
+    uint8_t *chrRam;
+    const uint8_t *chrBase;
+    size_t chrSize;
+    PPU *source;
+    uint8_t *sentPages[8];
+    uint32_t written;
+    uint32_t framesSent;
+    std::thread thread;
+    alignas(NES_CACHE_LINE) std::atomic<uint32_t> head;
+    alignas(NES_CACHE_LINE) std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> framesDone;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef NESC_RESAMPLER_H
+#define NESC_RESAMPLER_H
+
+#include "types.hpp"
+
+#define RESAMPLER_MAX_TAPS 32
+#define RESAMPLER_MAX_PHASE_BITS 8
+#define RESAMPLER_BUFFER_SIZE 1024
+
+// Windowed-sinc polyphase resampler from the APU's internal rate to the host
+// rate. Samples are 16-bit amplitudes and taps Q15, so every path (SSE2,
+// NEON, scalar) computes the same integer sums in both audio builds. The
+// filter bank depends on the quality and the rate ratio; it is rebuilt only
+// when those move by more than the producer's rate control does, otherwise
+// just the step between output samples is retuned.
+class Resampler {
+public:
+    void init();
+    void clear();
+    void setQuality(NesAudioQuality quality);
+    void setRates(double inputRate, double outputRate);
+    int process(const int *input, int inputCount, int *out, int capacity);
+
+private:
+    NesAudioQuality quality;
+    int taps;
+    int phaseBits;
+    double ratio;
+    double designRatio;
+    uint64_t step;
+    uint64_t position;
+    int count;
+    alignas(16) int16_t buffer[RESAMPLER_BUFFER_SIZE + RESAMPLER_MAX_TAPS];
+    alignas(16) int16_t bank[(1 << RESAMPLER_MAX_PHASE_BITS) * RESAMPLER_MAX_TAPS];
+
+    void buildBank();
+};
+
+#endif
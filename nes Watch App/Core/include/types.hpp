@@ -7,14 +7,90 @@
 
 #define NES_WIDTH 256
 #define NES_HEIGHT 240
+#define NES_NTSC_WIDTH 602
+#define NES_CACHE_LINE 64
 
 typedef enum {
     MIRROR_HORIZONTAL = 0,
-    MIRROR_VERTICAL = 1
+    MIRROR_VERTICAL = 1,
+    MIRROR_SINGLE_LOWER = 2,
+    MIRROR_SINGLE_UPPER = 3,
+    MIRROR_FOUR_SCREEN = 4
 } Mirroring;
 
+typedef enum {
+    NES_PIXEL_BGRA8888 = 0,
+    NES_PIXEL_RGBA8888 = 1,
+    NES_PIXEL_RGB565 = 2,
+    NES_PIXEL_GRAY8 = 3
+} NesPixelFormat;
+
+// Reduced outputs for small displays. Half modes write a 128-column frame,
+// either averaging each 2x2 block or keeping every other pixel of every other
+// line; cropping drops the 8 overscan lines at the top and bottom.
+typedef enum {
+    NES_SCALE_FULL = 0,
+    NES_SCALE_HALF_BOX = 1,
+    NES_SCALE_HALF_POINT = 2
+} NesOutputScale;
+
+#define NES_OVERSCAN_LINES 8
+
+// PPU implementation chosen when a ROM is loaded. The scanline renderer draws
+// each line in one pass from logged register writes; the dot renderer runs
+// the hardware fetch pipeline, shift registers and sprite evaluation per dot
+// for games that depend on exact mid-scanline behaviour.
+typedef enum {
+    NES_PPU_SCANLINE = 0,
+    NES_PPU_DOT = 1
+} NesPpuMode;
+
+// Filter length used when resampling the APU's internal rate to the host
+// rate: 8, 16 or 32 taps per output sample.
+typedef enum {
+    NES_AUDIO_QUALITY_LOW = 0,
+    NES_AUDIO_QUALITY_MEDIUM = 1,
+    NES_AUDIO_QUALITY_HIGH = 2
+} NesAudioQuality;
+
 typedef struct {
     uint32_t pixels[NES_WIDTH * NES_HEIGHT];
 } FrameBuffer;
 
+typedef struct {
+    uint32_t pixels[(NES_WIDTH / 2) * (NES_HEIGHT / 2)];
+} ScaledFrameBuffer;
+
+// A run of finished rows of the current output (ARGB, indexed or scaled),
+// delivered while the rest of the frame is still being emulated. The
+// timestamp is steady-clock nanoseconds taken when the band completed.
+typedef struct {
+    const void *pixels;
+    int bytesPerRow;
+    int firstRow;
+    int rowCount;
+    uint64_t timestamp;
+} NesBand;
+
+typedef void (*NesBandFunc)(void *context, const NesBand *band);
+
+// Palette indices (0-63, grayscale already applied) plus the PPUMASK
+// emphasis bits (0-7) in effect on each line.
+typedef struct {
+    uint8_t pixels[NES_WIDTH * NES_HEIGHT];
+    uint8_t emphasis[NES_HEIGHT];
+} IndexedFrameBuffer;
+
+// Change tracking over 8x8 blocks of the current output. Each finished row is
+// folded into a running hash per block; when a block row completes its hashes
+// are compared with the previous frame's. `dirty` holds one word per block
+// row, bit c covering columns 8c to 8c+7.
+#define NES_DIFF_BLOCK 8
+
+typedef struct {
+    uint64_t hashes[NES_HEIGHT / NES_DIFF_BLOCK][NES_WIDTH / NES_DIFF_BLOCK];
+    uint64_t pending[NES_WIDTH / NES_DIFF_BLOCK];
+    uint32_t dirty[NES_HEIGHT / NES_DIFF_BLOCK];
+} FrameDiff;
+
 #endif
@@ -20,6 +20,13 @@ static const uint16_t dmc_rate_table[16] = {
     190, 160, 142, 128, 106, 85, 72, 54
 };
 
+static const uint8_t pulse_duty_table[4][8] = {
+    {0, 1, 0, 0, 0, 0, 0, 0},
+    {0, 1, 1, 0, 0, 0, 0, 0},
+    {0, 1, 1, 1, 1, 0, 0, 0},
+    {1, 0, 0, 1, 1, 1, 1, 1}
+};
+
 static const uint8_t triangle_sequence[32] = {
     15, 14, 13, 12, 11, 10, 9, 8,
     7, 6, 5, 4, 3, 2, 1, 0,
@@ -27,8 +34,111 @@ static const uint8_t triangle_sequence[32] = {
     8, 9, 10, 11, 12, 13, 14, 15
 };
 
+// CPU cycle of each frame counter step; the five-step sequence ends on the
+// last entry, the four-step one wraps after the fourth.
+static const int frame_step_cycles[5] = {3729, 7457, 11186, 14915, 18641};
+
 static const double apu_cpu_clock = 1789773.0;
 
+// Runs a divider that reloads from period on the tick after it reaches zero
+// for the given number of ticks and returns how many times it reloaded.
+static int apu_run_divider(uint16_t &counter, uint16_t period, int ticks) {
+    if (ticks <= counter) {
+        counter = (uint16_t)(counter - ticks);
+        return 0;
+    }
+    int rest = ticks - counter - 1;
+    counter = (uint16_t)(period - rest % (period + 1));
+    return 1 + rest / (period + 1);
+}
+
+// Nonlinear DAC response from the nesdev approximations, indexed by the sum
+// of the pulse levels and by 3 * triangle + 2 * noise + DMC, in blip
+// amplitude units.
+struct ApuMixTables {
+    int pulse[31];
+    int tnd[203];
+
+    ApuMixTables() {
+        const double scale = (double)(1 << BLIP_AMPLITUDE_BITS);
+        pulse[0] = 0;
+        for (int i = 1; i < 31; i++) {
+            pulse[i] = (int)lround(95.52 / (8128.0 / i + 100.0) * scale);
+        }
+        tnd[0] = 0;
+        for (int i = 1; i < 203; i++) {
+            tnd[i] = (int)lround(163.67 / (24329.0 / i + 100.0) * scale);
+        }
+    }
+};
+
+static const ApuMixTables &apu_mix_tables() {
+    static const ApuMixTables tables;
+    return tables;
+}
+
+#if defined(NESC_FIXED_POINT_AUDIO)
+// Samples carry 8 guard bits below the blip amplitude so the 90 Hz stage does
+// not lose the signal to truncation; gains are Q16.
+#define APU_FIXED_GUARD_BITS 8
+#define APU_FIXED_GAIN_BITS 16
+
+static ApuSample apu_filter_gain(double gain) {
+    return (ApuSample)lround(gain * (1 << APU_FIXED_GAIN_BITS));
+}
+
+static ApuSample apu_filter_scale(ApuSample gain, ApuSample x) {
+    return (ApuSample)(((int64_t)gain * x) >> APU_FIXED_GAIN_BITS);
+}
+
+static ApuSample apu_sample_from_amplitude(int amplitude) {
+    return (ApuSample)(amplitude * (1 << APU_FIXED_GUARD_BITS));
+}
+
+static float apu_sample_to_float(ApuSample x) {
+    return (float)x * (1.0f / (float)(1 << (BLIP_AMPLITUDE_BITS + APU_FIXED_GUARD_BITS)));
+}
+#else
+static ApuSample apu_filter_gain(double gain) {
+    return (ApuSample)gain;
+}
+
+static ApuSample apu_filter_scale(ApuSample gain, ApuSample x) {
+    return gain * x;
+}
+
+static ApuSample apu_sample_from_amplitude(int amplitude) {
+    return (ApuSample)amplitude * (1.0f / (float)(1 << BLIP_AMPLITUDE_BITS));
+}
+
+static float apu_sample_to_float(ApuSample x) {
+    return x;
+}
+#endif
+
+void ApuFilter::setHighPass(double cutoff, double sampleRate) {
+    double rc = 1.0 / (2.0 * 3.141592653589793 * cutoff);
+    double dt = 1.0 / sampleRate;
+    gain = apu_filter_gain(rc / (rc + dt));
+}
+
+void ApuFilter::setLowPass(double cutoff, double sampleRate) {
+    double rc = 1.0 / (2.0 * 3.141592653589793 * cutoff);
+    double dt = 1.0 / sampleRate;
+    gain = apu_filter_gain(dt / (rc + dt));
+}
+
+ApuSample ApuFilter::highPass(ApuSample x) {
+    state = apu_filter_scale(gain, state + x - input);
+    input = x;
+    return state;
+}
+
+ApuSample ApuFilter::lowPass(ApuSample x) {
+    state += apu_filter_scale(gain, x - state);
+    return state;
+}
+
 void PulseChannel::writeControl(uint8_t data) {
     control = data;
     envStart = true;
@@ -51,6 +161,7 @@ void PulseChannel::writeTimerHigh(uint8_t data) {
     uint8_t lengthIndex = (data >> 3) & 0x1F;
     lengthCounter = apu_length_table[lengthIndex];
     envStart = true;
+    dutyPos = 0;
 }
 
 void PulseChannel::setEnabled(bool value) {
@@ -125,37 +236,47 @@ void PulseChannel::tickSweep() {
     }
 }
 
-double PulseChannel::sample(double sampleRate) {
-    if (!enabled || lengthCounter == 0) {
-        return 0.0;
-    }
-    if (timer < 8 || sweepMute) {
-        return 0.0;
+void PulseChannel::tickTimer() {
+    if (timerCounter == 0) {
+        timerCounter = timer;
+        dutyPos = (uint8_t)((dutyPos + 1) & 0x07);
+    } else {
+        timerCounter -= 1;
     }
+}
 
-    uint8_t duty = (uint8_t)((control >> 6) & 0x03);
-    double dutyCycle = 0.75;
-    switch (duty) {
-        case 0: dutyCycle = 0.125; break;
-        case 1: dutyCycle = 0.25; break;
-        case 2: dutyCycle = 0.5; break;
-        default: dutyCycle = 0.75; break;
-    }
+void PulseChannel::run(int ticks) {
+    int reloads = apu_run_divider(timerCounter, timer, ticks);
+    dutyPos = (uint8_t)((dutyPos + reloads) & 0x07);
+}
 
-    double frequency = apu_cpu_clock / (16.0 * ((double)timer + 1.0));
-    if (!isfinite(frequency) || frequency <= 0.0) {
-        return 0.0;
+// Timer ticks until the duty sequence next flips the output, skipping steps
+// that repeat the current bit.
+int PulseChannel::ticksToChange() const {
+    if (!enabled || lengthCounter == 0 || timer < 8 || sweepMute) {
+        return APU_NO_EVENT;
     }
-
-    phase += frequency / sampleRate;
-    if (phase >= 1.0) {
-        phase -= floor(phase);
+    bool constantVolume = (control & 0x10) != 0;
+    if ((constantVolume ? (control & 0x0F) : envDecay) == 0) {
+        return APU_NO_EVENT;
     }
+    const uint8_t *duty = pulse_duty_table[(control >> 6) & 0x03];
+    int steps = 1;
+    while (steps < 8 && duty[(dutyPos + steps) & 0x07] == duty[dutyPos]) {
+        steps += 1;
+    }
+    return timerCounter + 1 + (steps - 1) * (timer + 1);
+}
 
+uint8_t PulseChannel::output() const {
+    if (!enabled || lengthCounter == 0 || timer < 8 || sweepMute) {
+        return 0;
+    }
+    if (pulse_duty_table[(control >> 6) & 0x03][dutyPos] == 0) {
+        return 0;
+    }
     bool constantVolume = (control & 0x10) != 0;
-    uint8_t env = constantVolume ? (control & 0x0F) : envDecay;
-    double volume = (double)env;
-    return (phase < dutyCycle) ? volume : 0.0;
+    return constantVolume ? (uint8_t)(control & 0x0F) : envDecay;
 }
 
 void TriangleChannel::writeControl(uint8_t data) {
@@ -209,11 +330,25 @@ void TriangleChannel::tickTimer() {
     }
 }
 
-double TriangleChannel::sample() const {
+void TriangleChannel::run(int ticks) {
+    int reloads = apu_run_divider(timerCounter, timer, ticks);
+    if (lengthCounter > 0 && linearCounter > 0) {
+        sequencePos = (uint8_t)((sequencePos + reloads) & 0x1F);
+    }
+}
+
+int TriangleChannel::ticksToChange() const {
     if (!enabled || lengthCounter == 0 || linearCounter == 0) {
-        return 0.0;
+        return APU_NO_EVENT;
     }
-    return (double)triangle_sequence[sequencePos];
+    return timerCounter + 1;
+}
+
+uint8_t TriangleChannel::output() const {
+    if (!enabled || lengthCounter == 0 || linearCounter == 0) {
+        return 0;
+    }
+    return triangle_sequence[sequencePos];
 }
 
 void NoiseChannel::writeControl(uint8_t data) {
@@ -268,32 +403,55 @@ void NoiseChannel::tickEnvelope() {
     }
 }
 
+void NoiseChannel::shift() {
+    uint16_t feedback;
+    bool mode = (control & 0x80) != 0;
+    if (mode) {
+        feedback = (uint16_t)(((lfsr & 0x0001) ^ ((lfsr >> 6) & 0x0001)) & 0x0001);
+    } else {
+        feedback = (uint16_t)(((lfsr & 0x0001) ^ ((lfsr >> 1) & 0x0001)) & 0x0001);
+    }
+    lfsr = (uint16_t)((lfsr >> 1) | (feedback << 14));
+}
+
 void NoiseChannel::tickTimer() {
     if (timerCounter == 0) {
         timerCounter = timer;
-        uint16_t feedback;
-        bool mode = (control & 0x80) != 0;
-        if (mode) {
-            feedback = (uint16_t)(((lfsr & 0x0001) ^ ((lfsr >> 6) & 0x0001)) & 0x0001);
-        } else {
-            feedback = (uint16_t)(((lfsr & 0x0001) ^ ((lfsr >> 1) & 0x0001)) & 0x0001);
-        }
-        lfsr = (uint16_t)((lfsr >> 1) | (feedback << 14));
+        shift();
     } else {
         timerCounter -= 1;
     }
 }
 
-double NoiseChannel::sample() const {
+// The shift register keeps running while the channel is silent, so skipped
+// reloads still step it.
+void NoiseChannel::run(int ticks) {
+    int reloads = apu_run_divider(timerCounter, timer, ticks);
+    for (int i = 0; i < reloads; i++) {
+        shift();
+    }
+}
+
+int NoiseChannel::ticksToChange() const {
     if (!enabled || lengthCounter == 0) {
-        return 0.0;
+        return APU_NO_EVENT;
+    }
+    bool constantVolume = (control & 0x10) != 0;
+    if ((constantVolume ? (control & 0x0F) : envDecay) == 0) {
+        return APU_NO_EVENT;
+    }
+    return timerCounter + 1;
+}
+
+uint8_t NoiseChannel::output() const {
+    if (!enabled || lengthCounter == 0) {
+        return 0;
     }
     if (lfsr & 0x0001) {
-        return 0.0;
+        return 0;
     }
     bool constantVolume = (control & 0x10) != 0;
-    uint8_t env = constantVolume ? (control & 0x0F) : envDecay;
-    return (double)env;
+    return constantVolume ? (uint8_t)(control & 0x0F) : envDecay;
 }
 
 void DmcChannel::restart() {
@@ -382,33 +540,50 @@ void DmcChannel::tickTimer() {
     }
 }
 
-double DmcChannel::sample() const {
-    return (double)outputLevel;
+// Reloads with no bits left and nothing buffered do nothing, so only the
+// divider needs to move while the channel is idle.
+void DmcChannel::run(int ticks) {
+    apu_run_divider(timerCounter, timer, ticks);
+}
+
+int DmcChannel::ticksToChange() const {
+    if (bitCount == 0 && sampleBufferEmpty) {
+        return APU_NO_EVENT;
+    }
+    return timerCounter + 1;
+}
+
+uint8_t DmcChannel::output() const {
+    return outputLevel;
 }
 
 void APU::init() {
     memset(this, 0, sizeof(*this));
-    pthread_mutex_init(&mutex, NULL);
     pulse1.sweepOnesComplement = true;
     noise.lfsr = 1;
     dmc.sampleBufferEmpty = true;
-    outputFilter = 0.0;
-    sampleCycleRemainder = 0.0;
+    dirty = true;
+    quality = NES_AUDIO_QUALITY_MEDIUM;
+    blip.clear();
+    blip.setRates(apu_cpu_clock, APU_INTERNAL_RATE);
+    resampler.init();
+    setSampleRate(44100.0);
 }
 
+// Clears the sound hardware state but keeps the host connections, rate and
+// quality.
 void APU::reset() {
     ApuReadFunc readFunc = read;
     void *context = readContext;
-    pthread_mutex_destroy(&mutex);
-    memset(this, 0, sizeof(*this));
-    pthread_mutex_init(&mutex, NULL);
+    AudioRing *ring = output;
+    double rate = sampleRate;
+    NesAudioQuality level = quality;
+    init();
     read = readFunc;
     readContext = context;
-    pulse1.sweepOnesComplement = true;
-    noise.lfsr = 1;
-    dmc.sampleBufferEmpty = true;
-    outputFilter = 0.0;
-    sampleCycleRemainder = 0.0;
+    output = ring;
+    setSampleRate(rate);
+    setQuality(level);
 }
 
 void APU::setReadCallback(ApuReadFunc readFunc, void *context) {
@@ -416,8 +591,27 @@ void APU::setReadCallback(ApuReadFunc readFunc, void *context) {
     readContext = context;
 }
 
+void APU::setOutput(AudioRing *ring) {
+    output = ring;
+}
+
+// Only changes the resampler's step from the next output on, so the producer
+// can retune it between frames without a discontinuity.
+void APU::setSampleRate(double rate) {
+    sampleRate = rate;
+    resampler.setRates(APU_INTERNAL_RATE, rate);
+    highPass90.setHighPass(90.0, rate);
+    highPass440.setHighPass(440.0, rate);
+    lowPass.setLowPass(12000.0, rate);
+}
+
+void APU::setQuality(NesAudioQuality level) {
+    quality = level;
+    resampler.setQuality(level);
+}
+
 void APU::cpuWrite(uint16_t addr, uint8_t data) {
-    pthread_mutex_lock(&mutex);
+    dirty = true;
     switch (addr) {
         case 0x4000: pulse1.writeControl(data); break;
         case 0x4001: pulse1.writeSweep(data); break;
@@ -448,6 +642,7 @@ void APU::cpuWrite(uint16_t addr, uint8_t data) {
             frameCounterMode = (data & 0x80) != 0;
             frameIrqInhibit = (data & 0x40) != 0;
             frameCounterCycle = 0;
+            frameStep = 0;
             if (frameCounterMode) {
                 pulse1.tickLength();
                 pulse2.tickLength();
@@ -464,11 +659,9 @@ void APU::cpuWrite(uint16_t addr, uint8_t data) {
         default:
             break;
     }
-    pthread_mutex_unlock(&mutex);
 }
 
 uint8_t APU::readStatus() {
-    pthread_mutex_lock(&mutex);
     uint8_t value = 0;
     if (pulse1.enabled && pulse1.lengthCounter > 0) {
         value |= 0x01;
@@ -485,7 +678,6 @@ uint8_t APU::readStatus() {
     if (dmc.bytesRemaining > 0) {
         value |= 0x10;
     }
-    pthread_mutex_unlock(&mutex);
     return value;
 }
 
@@ -505,98 +697,146 @@ void APU::halfFrame() {
     pulse2.tickSweep();
 }
 
-void APU::stepCyclesUnlocked(int cycles) {
-    for (int i = 0; i < cycles; i++) {
-        frameCounterCycle += 1;
-        if (!frameCounterMode) {
-            if (frameCounterCycle == 3729) {
-                quarterFrame();
-            } else if (frameCounterCycle == 7457) {
-                quarterFrame();
-                halfFrame();
-            } else if (frameCounterCycle == 11186) {
-                quarterFrame();
-            } else if (frameCounterCycle == 14915) {
-                quarterFrame();
-                halfFrame();
-                frameCounterCycle = 0;
-            }
-        } else {
-            if (frameCounterCycle == 3729) {
-                quarterFrame();
-            } else if (frameCounterCycle == 7457) {
-                quarterFrame();
-                halfFrame();
-            } else if (frameCounterCycle == 11186) {
-                quarterFrame();
-            } else if (frameCounterCycle == 14915) {
-                quarterFrame();
-                halfFrame();
-            } else if (frameCounterCycle == 18641) {
+void APU::frameCounterStep() {
+    switch (frameStep) {
+        case 0:
+        case 2:
+            quarterFrame();
+            frameStep += 1;
+            break;
+        case 1:
+            quarterFrame();
+            halfFrame();
+            frameStep += 1;
+            break;
+        case 3:
+            quarterFrame();
+            halfFrame();
+            frameStep = frameCounterMode ? 4 : 0;
+            if (!frameCounterMode) {
                 frameCounterCycle = 0;
             }
-        }
-
-        triangle.tickTimer();
-        noise.tickTimer();
-        dmc.tickTimer();
-        dmc.fetchSample(read, readContext);
+            break;
+        default:
+            frameStep = 0;
+            frameCounterCycle = 0;
+            break;
     }
 }
 
-void APU::step(int cycles) {
-    pthread_mutex_lock(&mutex);
-    stepCyclesUnlocked(cycles);
-    pthread_mutex_unlock(&mutex);
-}
-
-float APU::nextSampleUnlocked(double sample_rate) {
-    double p1 = pulse1.sample(sample_rate);
-    double p2 = pulse2.sample(sample_rate);
-    double t = triangle.sample();
-    double n = noise.sample();
-    double d = dmc.sample();
-
-    double pulseOut = 0.0;
-    if (p1 + p2 > 0.0) {
-        pulseOut = 95.88 / ((8128.0 / (p1 + p2)) + 100.0);
+// One CPU cycle with everything that falls on it.
+void APU::clock() {
+    frameCounterCycle += 1;
+    if (frameCounterCycle == frame_step_cycles[frameStep]) {
+        frameCounterStep();
+    }
+    if (oddCycle) {
+        pulse1.tickTimer();
+        pulse2.tickTimer();
+    }
+    oddCycle = !oddCycle;
+    triangle.tickTimer();
+    noise.tickTimer();
+    dmc.tickTimer();
+    dmc.fetchSample(read, readContext);
+}
+
+// Cycles in which no output changes and no frame counter step falls. The
+// dividers and sequencers still move, just arithmetically.
+void APU::advance(int cycles) {
+    frameCounterCycle += cycles;
+    int pulseTicks = oddCycle ? (cycles + 1) / 2 : cycles / 2;
+    pulse1.run(pulseTicks);
+    pulse2.run(pulseTicks);
+    oddCycle = oddCycle != ((cycles & 1) != 0);
+    triangle.run(cycles);
+    noise.run(cycles);
+    dmc.run(cycles);
+}
+
+// Cycles until the next one that changes what the channels output or steps
+// the frame counter. Pulse timers tick on every other CPU cycle.
+int APU::cyclesToEvent() const {
+    int next = frame_step_cycles[frameStep] - frameCounterCycle;
+    int pulseTicks = pulse1.ticksToChange();
+    int ticks = pulse2.ticksToChange();
+    if (ticks < pulseTicks) {
+        pulseTicks = ticks;
+    }
+    if (pulseTicks != APU_NO_EVENT) {
+        int cycles = oddCycle ? pulseTicks * 2 - 1 : pulseTicks * 2;
+        if (cycles < next) {
+            next = cycles;
+        }
     }
-    double tndOut = 0.0;
-    double tnd = (t / 8227.0) + (n / 12241.0) + (d / 22638.0);
-    if (tnd > 0.0) {
-        tndOut = 159.79 / ((1.0 / tnd) + 100.0);
+    int channelTicks[3] = {triangle.ticksToChange(), noise.ticksToChange(), dmc.ticksToChange()};
+    for (int i = 0; i < 3; i++) {
+        if (channelTicks[i] < next) {
+            next = channelTicks[i];
+        }
     }
-    double mixed = pulseOut + tndOut;
-    double cutoff = 12000.0;
-    double rc = 1.0 / (2.0 * 3.141592653589793 * cutoff);
-    double dt = 1.0 / sample_rate;
-    double alpha = dt / (rc + dt);
-    outputFilter += alpha * (mixed - outputFilter);
-    return (float)outputFilter;
+    return next;
 }
 
-float APU::nextSample(double sample_rate) {
-    float sampleValue = 0.0f;
-    pthread_mutex_lock(&mutex);
-    sampleValue = nextSampleUnlocked(sample_rate);
-    pthread_mutex_unlock(&mutex);
-    return sampleValue;
+// Jumps from event to event instead of ticking every cycle. Register writes
+// can change any channel, so the next event is found again after one.
+void APU::step(int cycles) {
+    if (dirty) {
+        dirty = false;
+        dmc.fetchSample(read, readContext);
+        updateOutput();
+        nextEvent = cyclesToEvent();
+    }
+    while (cycles > 0) {
+        int n = nextEvent < cycles ? nextEvent : cycles;
+        int room = APU_BLIP_CHUNK_CYCLES - (int)blipTime;
+        if (n > room) {
+            n = room;
+        }
+        if (n == nextEvent) {
+            advance(n - 1);
+            blipTime += (uint32_t)(n - 1);
+            clock();
+            updateOutput();
+            blipTime += 1;
+            nextEvent = cyclesToEvent();
+        } else {
+            advance(n);
+            blipTime += (uint32_t)n;
+            nextEvent -= n;
+        }
+        cycles -= n;
+        if (blipTime == APU_BLIP_CHUNK_CYCLES) {
+            flush();
+        }
+    }
 }
 
-void APU::fillBuffer(double sample_rate, float *out, int count) {
-    if (!out || count <= 0) {
-        return;
+// Looked up after every event and register write; a delta is only added when
+// the amplitude actually moved.
+void APU::updateOutput() {
+    const ApuMixTables &tables = apu_mix_tables();
+    int next = tables.pulse[pulse1.output() + pulse2.output()] +
+               tables.tnd[3 * triangle.output() + 2 * noise.output() + dmc.output()];
+    if (next != amplitude) {
+        blip.addDelta(blipTime, next - amplitude);
+        amplitude = next;
     }
-    double cyclesPerSample = apu_cpu_clock / sample_rate;
-    pthread_mutex_lock(&mutex);
+}
+
+void APU::flush() {
+    blip.endFrame(blipTime);
+    blipTime = 0;
+    int internalCount = blip.readSamples(internal, APU_INTERNAL_SAMPLES);
+    int count = resampler.process(internal, internalCount, mixed, APU_PENDING_SAMPLES);
     for (int i = 0; i < count; i++) {
-        sampleCycleRemainder += cyclesPerSample;
-        int cycles = (int)sampleCycleRemainder;
-        if (cycles > 0) {
-            stepCyclesUnlocked(cycles);
-            sampleCycleRemainder -= (double)cycles;
-        }
-        out[i] = nextSampleUnlocked(sample_rate);
+        ApuSample x = apu_sample_from_amplitude(mixed[i]);
+        x = highPass90.highPass(x);
+        x = highPass440.highPass(x);
+        x = lowPass.lowPass(x);
+        pending[i] = apu_sample_to_float(x);
+    }
+    if (output && count > 0) {
+        output->write(pending, count);
     }
-    pthread_mutex_unlock(&mutex);
 }
@@ -0,0 +1,59 @@
+#include "../include/audio_ring.hpp"
+
+#include <string.h>
+
+#define AUDIO_DEFAULT_RATE 44100
+#define AUDIO_TARGET_LATENCY 0.05
+#define AUDIO_MAX_RATE_ADJUST 0.005
+
+AudioRing::AudioRing() : head(0), tail(0), rate(AUDIO_DEFAULT_RATE) {
+    memset(samples, 0, sizeof(samples));
+}
+
+void AudioRing::setRate(double value) {
+    if (value >= 1000.0 && value <= 384000.0) {
+        rate.store((uint32_t)(value + 0.5), std::memory_order_relaxed);
+    }
+}
+
+// The emulation timer and the audio clock drift apart, so the producer runs
+// up to 0.5% fast or slow to hold the fill level near the target latency
+// instead of periodically starving or overflowing the ring.
+double AudioRing::producerRate() const {
+    double nominal = (double)rate.load(std::memory_order_relaxed);
+    double target = nominal * AUDIO_TARGET_LATENCY;
+    double error = (target - (double)available()) / target;
+    if (error > 1.0) error = 1.0;
+    if (error < -1.0) error = -1.0;
+    return nominal * (1.0 + AUDIO_MAX_RATE_ADJUST * error);
+}
+
+int AudioRing::write(const float *input, int count) {
+    uint32_t end = head.load(std::memory_order_relaxed);
+    uint32_t start = tail.load(std::memory_order_acquire);
+    uint32_t space = AUDIO_RING_CAPACITY - (end - start);
+    uint32_t n = count < 0 ? 0 : ((uint32_t)count < space ? (uint32_t)count : space);
+    uint32_t offset = end % AUDIO_RING_CAPACITY;
+    uint32_t first = n < AUDIO_RING_CAPACITY - offset ? n : AUDIO_RING_CAPACITY - offset;
+    memcpy(samples + offset, input, first * sizeof(float));
+    memcpy(samples, input + first, (n - first) * sizeof(float));
+    head.store(end + n, std::memory_order_release);
+    return (int)n;
+}
+
+int AudioRing::read(float *out, int count) {
+    uint32_t start = tail.load(std::memory_order_relaxed);
+    uint32_t end = head.load(std::memory_order_acquire);
+    uint32_t ready = end - start;
+    uint32_t n = count < 0 ? 0 : ((uint32_t)count < ready ? (uint32_t)count : ready);
+    uint32_t offset = start % AUDIO_RING_CAPACITY;
+    uint32_t first = n < AUDIO_RING_CAPACITY - offset ? n : AUDIO_RING_CAPACITY - offset;
+    memcpy(out, samples + offset, first * sizeof(float));
+    memcpy(out + first, samples, (n - first) * sizeof(float));
+    tail.store(start + n, std::memory_order_release);
+    return (int)n;
+}
+
+int AudioRing::available() const {
+    return (int)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
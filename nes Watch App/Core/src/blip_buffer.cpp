@@ -0,0 +1,99 @@
+#include "../include/blip_buffer.hpp"
+
+#include <math.h>
+#include <string.h>
+
+// Cutoff as a fraction of the output rate; the 16-tap Blackman window rolls
+// off the last few kHz below Nyquist in exchange for little aliasing.
+#define BLIP_CUTOFF 0.45
+
+// One kernel per sub-sample phase plus the next sample's phase 0, so adjacent
+// phases can be interpolated. Each row sums to exactly 1 << BLIP_DELTA_BITS,
+// which keeps the integrated output free of drift.
+struct BlipKernel {
+    int16_t taps[BLIP_PHASES + 1][BLIP_WIDTH];
+
+    BlipKernel() {
+        const double pi = 3.141592653589793;
+        for (int phase = 0; phase <= BLIP_PHASES; phase++) {
+            double shift = (double)phase / BLIP_PHASES;
+            double row[BLIP_WIDTH];
+            double total = 0.0;
+            for (int k = 0; k < BLIP_WIDTH; k++) {
+                double x = (double)(k - (BLIP_HALF_WIDTH - 1)) - shift;
+                double sinc = x == 0.0 ? 2.0 * BLIP_CUTOFF : sin(2.0 * pi * BLIP_CUTOFF * x) / (pi * x);
+                double w = x / BLIP_HALF_WIDTH;
+                double window = 0.42 + 0.5 * cos(pi * w) + 0.08 * cos(2.0 * pi * w);
+                row[k] = sinc * window;
+                total += row[k];
+            }
+            int sum = 0;
+            int peak = 0;
+            for (int k = 0; k < BLIP_WIDTH; k++) {
+                taps[phase][k] = (int16_t)lround(row[k] / total * (1 << BLIP_DELTA_BITS));
+                sum += taps[phase][k];
+                if (taps[phase][k] > taps[phase][peak]) {
+                    peak = k;
+                }
+            }
+            taps[phase][peak] = (int16_t)(taps[phase][peak] + (1 << BLIP_DELTA_BITS) - sum);
+        }
+    }
+};
+
+static const BlipKernel &blip_kernel() {
+    static const BlipKernel kernel;
+    return kernel;
+}
+
+void BlipBuffer::clear() {
+    offset = 0;
+    integrator = 0;
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void BlipBuffer::setRates(double clockRate, double sampleRate) {
+    factor = (uint64_t)(sampleRate / clockRate * (double)(1ULL << BLIP_FRAC_BITS) + 0.5);
+    blip_kernel();
+}
+
+// The delta lands between two kernel phases; splitting it by the remaining
+// fraction interpolates them while keeping the total contribution exact.
+void BlipBuffer::addDelta(uint32_t time, int delta) {
+    uint64_t fixed = offset + (uint64_t)time * factor;
+    int *out = buffer + (fixed >> BLIP_FRAC_BITS);
+    int phase = (int)(fixed >> (BLIP_FRAC_BITS - BLIP_PHASE_BITS)) & (BLIP_PHASES - 1);
+    int interp = (int)(fixed >> (BLIP_FRAC_BITS - BLIP_PHASE_BITS - BLIP_DELTA_BITS)) & ((1 << BLIP_DELTA_BITS) - 1);
+    int delta2 = (delta * interp) >> BLIP_DELTA_BITS;
+    int delta1 = delta - delta2;
+    const int16_t *a = blip_kernel().taps[phase];
+    const int16_t *b = blip_kernel().taps[phase + 1];
+    for (int k = 0; k < BLIP_WIDTH; k++) {
+        out[k] += a[k] * delta1 + b[k] * delta2;
+    }
+}
+
+void BlipBuffer::endFrame(uint32_t time) {
+    offset += (uint64_t)time * factor;
+}
+
+int BlipBuffer::samplesAvailable() const {
+    return (int)(offset >> BLIP_FRAC_BITS);
+}
+
+int BlipBuffer::readSamples(int *out, int count) {
+    int available = samplesAvailable();
+    int n = count < available ? count : available;
+    int sum = integrator;
+    for (int i = 0; i < n; i++) {
+        sum += buffer[i];
+        out[i] = sum >> BLIP_DELTA_BITS;
+    }
+    integrator = sum;
+
+    int remaining = available - n + BLIP_WIDTH;
+    memmove(buffer, buffer + n, (size_t)remaining * sizeof(int));
+    memset(buffer + remaining, 0, (size_t)n * sizeof(int));
+    offset -= (uint64_t)n << BLIP_FRAC_BITS;
+    return n;
+}
@@ -8,7 +8,10 @@ uint8_t Bus::cpuReadInternal(uint16_t addr) {
             return cartData;
         }
     }
+    return readSystem(addr);
+}
 
+uint8_t Bus::readSystem(uint16_t addr) {
     if (addr <= 0x1FFF) {
         uint8_t value = cpuRam[addr & 0x07FF];
         dataBus = value;
@@ -97,9 +100,13 @@ void Bus::cpuWrite(uint16_t addr, uint8_t data) {
     dataBus = data;
 
     if (cartridge && cartridge->cpuWrite(addr, data)) {
+        syncMirroring();
         return;
     }
+    writeSystem(addr, data);
+}
 
+void Bus::writeSystem(uint16_t addr, uint8_t data) {
     if (addr <= 0x1FFF) {
         cpuRam[addr & 0x07FF] = data;
         return;
@@ -134,6 +141,12 @@ void Bus::cpuWrite(uint16_t addr, uint8_t data) {
     }
 }
 
+void Bus::syncMirroring() {
+    if (ppu && ppu->mirroring != cartridge->mirroring) {
+        ppu->setMirroring(cartridge->mirroring);
+    }
+}
+
 bool Bus::isIrqPending() {
     return irqPending;
 }
@@ -3,9 +3,19 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "../include/mapper/cnrom.hpp"
-#include "../include/mapper/mmc1.hpp"
-#include "../include/mapper/nrom.hpp"
+#include <type_traits>
+
+#include "../include/mapper/mapper_list.hpp"
+
+// Mappers that size their banking from the header take the bank counts.
+template <class M>
+static std::unique_ptr<Mapper> create_mapper(int prgBanks, int chrBanks) {
+    if constexpr (std::is_constructible_v<M, int, int>) {
+        return std::make_unique<M>(prgBanks, chrBanks);
+    } else {
+        return std::make_unique<M>();
+    }
+}
 
 void Cartridge::free() {
     ::free(prgROM);
@@ -34,7 +44,11 @@ bool Cartridge::load(const uint8_t *data, size_t size) {
     uint8_t flags7 = data[7];
 
     mapperID = (uint8_t)((flags7 & 0xF0) | (flags6 >> 4));
-    mirroring = (flags6 & 0x01) == 0 ? MIRROR_HORIZONTAL : MIRROR_VERTICAL;
+    if (flags6 & 0x08) {
+        mirroring = MIRROR_FOUR_SCREEN;
+    } else {
+        mirroring = (flags6 & 0x01) == 0 ? MIRROR_HORIZONTAL : MIRROR_VERTICAL;
+    }
 
     size_t offset = 16;
     if (flags6 & 0x04) {
@@ -75,15 +89,17 @@ bool Cartridge::load(const uint8_t *data, size_t size) {
     }
 
     mapper.reset();
-    if (mapperID == 0) {
-        mapper = std::make_unique<NromMapper>(prgBanks, chrBanks);
-    } else if (mapperID == 1) {
-        mapper = std::make_unique<Mmc1Mapper>();
-    } else if (mapperID == 3) {
-        mapper = std::make_unique<CnromMapper>();
-    } else {
-        return false;
+    switch (mapperID) {
+#define NESC_CREATE_MAPPER(id, Type)                      \
+    case id:                                              \
+        mapper = create_mapper<Type>(prgBanks, chrBanks); \
+        break;
+        NESC_MAPPER_LIST(NESC_CREATE_MAPPER)
+#undef NESC_CREATE_MAPPER
+        default:
+            return false;
     }
+    mapper->updateBanks(*this);
     return true;
 }
 
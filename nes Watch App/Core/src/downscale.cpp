@@ -0,0 +1,112 @@
+#include "../include/downscale.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Each output channel is the rounded mean of a 2x2 block: (a + b + c + d + 2) >> 2.
+static uint32_t box_pixel(const uint32_t *top, const uint32_t *bottom, int x) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t sum = ((top[x * 2] >> shift) & 0xFF) + ((top[x * 2 + 1] >> shift) & 0xFF) +
+                       ((bottom[x * 2] >> shift) & 0xFF) + ((bottom[x * 2 + 1] >> shift) & 0xFF);
+        result |= ((sum + 2) >> 2) << shift;
+    }
+    return result;
+}
+
+#if defined(__SSE2__)
+
+// Four input pixels from each row to two output pixels, as 16-bit sums.
+static inline __m128i box_sums(const uint32_t *top, const uint32_t *bottom) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_loadu_si128((const __m128i *)top);
+    __m128i b = _mm_loadu_si128((const __m128i *)bottom);
+    __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+    __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+    __m128i sums = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+    return _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(2)), 2);
+}
+
+static int box_simd(const uint32_t *top, const uint32_t *bottom, uint32_t *out, int width) {
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i first = box_sums(top + x * 2, bottom + x * 2);
+        __m128i second = box_sums(top + x * 2 + 4, bottom + x * 2 + 4);
+        _mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(first, second));
+    }
+    return x;
+}
+
+static int point_simd(const uint32_t *in, uint32_t *out, int width) {
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(in + x * 2)));
+        __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(in + x * 2 + 4)));
+        _mm_storeu_si128((__m128i *)(out + x), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))));
+    }
+    return x;
+}
+
+#elif defined(__ARM_NEON)
+
+static inline uint8x8_t box_pair(const uint32_t *top, const uint32_t *bottom) {
+    uint8x16_t a = vreinterpretq_u8_u32(vld1q_u32(top));
+    uint8x16_t b = vreinterpretq_u8_u32(vld1q_u32(bottom));
+    uint16x8_t low = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+    uint16x8_t high = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+    uint16x8_t sums = vaddq_u16(vcombine_u16(vget_low_u16(low), vget_low_u16(high)),
+                                vcombine_u16(vget_high_u16(low), vget_high_u16(high)));
+    return vrshrn_n_u16(sums, 2);
+}
+
+static int box_simd(const uint32_t *top, const uint32_t *bottom, uint32_t *out, int width) {
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        uint8x16_t pixels = vcombine_u8(box_pair(top + x * 2, bottom + x * 2),
+                                        box_pair(top + x * 2 + 4, bottom + x * 2 + 4));
+        vst1q_u32(out + x, vreinterpretq_u32_u8(pixels));
+    }
+    return x;
+}
+
+static int point_simd(const uint32_t *in, uint32_t *out, int width) {
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        vst1q_u32(out + x, vld2q_u32(in + x * 2).val[0]);
+    }
+    return x;
+}
+
+#else
+
+static int box_simd(const uint32_t *top, const uint32_t *bottom, uint32_t *out, int width) {
+    (void)top;
+    (void)bottom;
+    (void)out;
+    (void)width;
+    return 0;
+}
+
+static int point_simd(const uint32_t *in, uint32_t *out, int width) {
+    (void)in;
+    (void)out;
+    (void)width;
+    return 0;
+}
+
+#endif
+
+void downscale_box_rows(const uint32_t *top, const uint32_t *bottom, uint32_t *out, int width) {
+    for (int x = box_simd(top, bottom, out, width); x < width; x++) {
+        out[x] = box_pixel(top, bottom, x);
+    }
+}
+
+void downscale_point_row(const uint32_t *in, uint32_t *out, int width) {
+    for (int x = point_simd(in, out, width); x < width; x++) {
+        out[x] = in[x * 2];
+    }
+}
@@ -0,0 +1,41 @@
+#include "../include/frame_exchange.hpp"
+
+#define FRAME_INDEX_MASK 0x03
+#define FRAME_FRESH 0x04
+#define FRAME_SEQUENCE_SHIFT 3
+
+// Not synchronised with publish/acquire; call while neither side is running.
+void FrameExchange::attach(uint32_t *const *frames) {
+    for (int i = 0; i < 3; i++) {
+        buffers[i] = frames ? frames[i] : nullptr;
+    }
+    back = 0;
+    latest = 0;
+    published = 0;
+    front = 1;
+    frontSequence = 0;
+    shared.store(2, std::memory_order_relaxed);
+}
+
+void FrameExchange::publish() {
+    published += 1;
+    latest = back;
+    uint64_t slot = (published << FRAME_SEQUENCE_SHIFT) | FRAME_FRESH | (uint64_t)back;
+    uint64_t previous = shared.exchange(slot, std::memory_order_acq_rel);
+    back = (int)(previous & FRAME_INDEX_MASK);
+}
+
+// Returns the newest frame, which stays untouched until the next call, or the
+// frame already held when nothing new has been published. Returns null before
+// the first frame.
+const uint32_t *FrameExchange::acquire(uint64_t *sequence) {
+    if ((shared.load(std::memory_order_acquire) & FRAME_FRESH) != 0) {
+        uint64_t previous = shared.exchange((uint64_t)front, std::memory_order_acq_rel);
+        front = (int)(previous & FRAME_INDEX_MASK);
+        frontSequence = previous >> FRAME_SEQUENCE_SHIFT;
+    }
+    if (sequence) {
+        *sequence = frontSequence;
+    }
+    return frontSequence != 0 ? buffers[front] : nullptr;
+}
@@ -2,21 +2,10 @@
 
 #include "../../include/cartridge.hpp"
 
-bool CnromMapper::cpuRead(Cartridge &cart, uint16_t addr, uint8_t *out) {
-    if (addr < 0x8000) {
-        return false;
-    }
-    uint32_t mapped = 0;
-    if (cart.prgSize == 16 * 1024) {
-        mapped = (uint32_t)(addr & 0x3FFF);
-    } else {
-        mapped = (uint32_t)(addr - 0x8000);
-    }
-    if (mapped >= cart.prgSize) {
-        return false;
-    }
-    *out = cart.prgROM[mapped];
-    return true;
+void CnromMapper::updateBanks(Cartridge &cart) {
+    mapPrg(cart, 0, 4, 0);
+    mapPrg(cart, 4, 4, cart.prgSize == 16 * 1024 ? 0 : 16 * 1024);
+    mapChr(cart, 0, 8, (uint32_t)chrBank * 8 * 1024);
 }
 
 bool CnromMapper::cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
@@ -35,52 +24,6 @@ bool CnromMapper::cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
         bank = 0;
     }
     chrBank = bank;
-    return true;
-}
-
-bool CnromMapper::ppuRead(Cartridge &cart, uint16_t addr, uint8_t *out) {
-    if (addr >= 0x2000) {
-        return false;
-    }
-    int chrBankCount = (int)(cart.chrSize / (8 * 1024));
-    if (chrBankCount <= 0) {
-        return false;
-    }
-    uint8_t bank = chrBank;
-    if ((chrBankCount & (chrBankCount - 1)) == 0) {
-        bank = (uint8_t)(bank & (uint8_t)(chrBankCount - 1));
-    } else {
-        bank = (uint8_t)(bank % chrBankCount);
-    }
-    uint32_t mapped = (uint32_t)bank * 8 * 1024 + addr;
-    if (mapped >= cart.chrSize) {
-        return false;
-    }
-    *out = cart.chrROM[mapped];
-    return true;
-}
-
-bool CnromMapper::ppuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
-    if (!cart.hasChrRam) {
-        return false;
-    }
-    if (addr >= 0x2000) {
-        return false;
-    }
-    int chrBankCount = (int)(cart.chrSize / (8 * 1024));
-    if (chrBankCount <= 0) {
-        return false;
-    }
-    uint8_t bank = chrBank;
-    if ((chrBankCount & (chrBankCount - 1)) == 0) {
-        bank = (uint8_t)(bank & (uint8_t)(chrBankCount - 1));
-    } else {
-        bank = (uint8_t)(bank % chrBankCount);
-    }
-    uint32_t mapped = (uint32_t)bank * 8 * 1024 + addr;
-    if (mapped >= cart.chrSize) {
-        return false;
-    }
-    cart.chrROM[mapped] = data;
+    updateBanks(cart);
     return true;
 }
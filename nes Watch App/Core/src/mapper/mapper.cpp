@@ -0,0 +1,18 @@
+#include "../../include/mapper/mapper.hpp"
+
+#include "../../include/cartridge.hpp"
+
+void Mapper::mapPrg(Cartridge &cart, int page, int count, uint32_t offset) {
+    for (int i = 0; i < count; i++) {
+        uint32_t start = offset + (uint32_t)i * MAPPER_PRG_PAGE_SIZE;
+        prgPages[page + i] = start < cart.prgSize ? cart.prgROM + start : nullptr;
+    }
+}
+
+void Mapper::mapChr(Cartridge &cart, int page, int count, uint32_t offset) {
+    for (int i = 0; i < count; i++) {
+        uint32_t start = offset + (uint32_t)i * MAPPER_CHR_PAGE_SIZE;
+        chrPages[page + i] = start < cart.chrSize ? cart.chrROM + start : nullptr;
+    }
+    chrWritable = cart.hasChrRam;
+}
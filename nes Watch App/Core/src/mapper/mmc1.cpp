@@ -4,60 +4,46 @@
 
 void Mmc1Mapper::applyControl(Cartridge &cart, uint8_t value) {
     control = value;
-    uint8_t mirror = value & 0x03;
-    if (mirror == 3) {
-        cart.mirroring = MIRROR_HORIZONTAL;
-    } else {
-        cart.mirroring = MIRROR_VERTICAL;
+    switch (value & 0x03) {
+        case 0: cart.mirroring = MIRROR_SINGLE_LOWER; break;
+        case 1: cart.mirroring = MIRROR_SINGLE_UPPER; break;
+        case 2: cart.mirroring = MIRROR_VERTICAL; break;
+        default: cart.mirroring = MIRROR_HORIZONTAL; break;
     }
 }
 
-bool Mmc1Mapper::cpuRead(Cartridge &cart, uint16_t addr, uint8_t *out) {
-    if (addr < 0x8000) {
-        return false;
-    }
+void Mmc1Mapper::updateBanks(Cartridge &cart) {
     uint8_t prgMode = (control >> 2) & 0x03;
     int prgBankCount = (int)(cart.prgSize / (16 * 1024));
     int bank = prgBank & 0x0F;
-    uint32_t mapped = 0;
+    uint32_t bankSize = 16 * 1024;
 
-    switch (prgMode) {
+    switch (prgBankCount > 0 ? prgMode : 0) {
         case 0:
         case 1: {
             int bank32 = (bank & 0x0E);
-            if (addr < 0xC000) {
-                mapped = (uint32_t)bank32 * 16 * 1024 + (addr - 0x8000);
-            } else {
-                mapped = (uint32_t)(bank32 + 1) * 16 * 1024 + (addr - 0xC000);
-            }
+            mapPrg(cart, 0, 4, (uint32_t)bank32 * bankSize);
+            mapPrg(cart, 4, 4, (uint32_t)(bank32 + 1) * bankSize);
             break;
         }
-        case 2: {
-            if (addr < 0xC000) {
-                mapped = (uint32_t)(0 * 16 * 1024 + (addr - 0x8000));
-            } else {
-                int b = bank % prgBankCount;
-                mapped = (uint32_t)b * 16 * 1024 + (addr - 0xC000);
-            }
+        case 2:
+            mapPrg(cart, 0, 4, 0);
+            mapPrg(cart, 4, 4, (uint32_t)(bank % prgBankCount) * bankSize);
             break;
-        }
         case 3:
-        default: {
-            if (addr < 0xC000) {
-                int b = bank % prgBankCount;
-                mapped = (uint32_t)b * 16 * 1024 + (addr - 0x8000);
-            } else {
-                mapped = (uint32_t)(prgBankCount - 1) * 16 * 1024 + (addr - 0xC000);
-            }
+        default:
+            mapPrg(cart, 0, 4, (uint32_t)(bank % prgBankCount) * bankSize);
+            mapPrg(cart, 4, 4, (uint32_t)(prgBankCount - 1) * bankSize);
             break;
-        }
     }
 
-    if (mapped >= cart.prgSize) {
-        return false;
+    uint8_t chrMode = (control >> 4) & 0x01;
+    if (chrMode == 0) {
+        mapChr(cart, 0, 8, (uint32_t)(chrBank0 & 0x1E) * 4 * 1024);
+    } else {
+        mapChr(cart, 0, 4, (uint32_t)chrBank0 * 4 * 1024);
+        mapChr(cart, 4, 4, (uint32_t)chrBank1 * 4 * 1024);
     }
-    *out = cart.prgROM[mapped];
-    return true;
 }
 
 bool Mmc1Mapper::cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
@@ -68,6 +54,7 @@ bool Mmc1Mapper::cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
         shiftReg = 0x10;
         shiftCount = 0;
         control |= 0x0C;
+        updateBanks(cart);
         return true;
     }
 
@@ -87,55 +74,7 @@ bool Mmc1Mapper::cpuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
         }
         shiftReg = 0x10;
         shiftCount = 0;
+        updateBanks(cart);
     }
     return true;
 }
-
-bool Mmc1Mapper::ppuRead(Cartridge &cart, uint16_t addr, uint8_t *out) {
-    if (addr >= 0x2000) {
-        return false;
-    }
-    uint8_t chrMode = (control >> 4) & 0x01;
-    uint32_t mapped = 0;
-    if (chrMode == 0) {
-        uint32_t bank = (uint32_t)(chrBank0 & 0x1E);
-        mapped = bank * 4 * 1024 + addr;
-    } else {
-        if (addr < 0x1000) {
-            mapped = (uint32_t)chrBank0 * 4 * 1024 + addr;
-        } else {
-            mapped = (uint32_t)chrBank1 * 4 * 1024 + (addr - 0x1000);
-        }
-    }
-    if (mapped >= cart.chrSize) {
-        return false;
-    }
-    *out = cart.chrROM[mapped];
-    return true;
-}
-
-bool Mmc1Mapper::ppuWrite(Cartridge &cart, uint16_t addr, uint8_t data) {
-    if (!cart.hasChrRam) {
-        return false;
-    }
-    if (addr >= 0x2000) {
-        return false;
-    }
-    uint8_t chrMode = (control >> 4) & 0x01;
-    uint32_t mapped = 0;
-    if (chrMode == 0) {
-        uint32_t bank = (uint32_t)(chrBank0 & 0x1E);
-        mapped = bank * 4 * 1024 + addr;
-    } else {
-        if (addr < 0x1000) {
-            mapped = (uint32_t)chrBank0 * 4 * 1024 + addr;
-        } else {
-            mapped = (uint32_t)chrBank1 * 4 * 1024 + (addr - 0x1000);
-        }
-    }
-    if (mapped >= cart.chrSize) {
-        return false;
-    }
-    cart.chrROM[mapped] = data;
-    return true;
-}
@@ -3,99 +3,188 @@
 #include <string.h>
 
 #include "../include/nes_internal.hpp"
+#include "../include/ntsc_filter.hpp"
+#include "../include/pixel_format.hpp"
 
-static uint8_t nes_bus_read(void *context, uint16_t addr) {
-    return ((Bus *)context)->cpuRead(addr);
-}
+// Only DefaultConfig is reachable through this API; instantiating the headless
+// build here keeps it compiling with every change to Machine.
+template class Machine<HeadlessConfig>;
+static_assert(sizeof(Machine<HeadlessConfig>) < 40 * 1024, "Headless machine must leave out render and audio buffers");
 
-NES::NES() : hasCart(false) {
-    apu.init();
-    bus.cpu = &cpu;
-    bus.ppu = &ppu;
-    bus.apu = &apu;
-    cpu.init();
-    cpu.bus = &bus;
-    apu.setReadCallback(nes_bus_read, &bus);
+NESRef nes_create(void) {
+    return new NES();
 }
 
-NES::~NES() {
-    cart.free();
+void nes_destroy(NESRef nes) {
+    delete nes;
 }
 
-bool NES::loadRom(const uint8_t *data, size_t size) {
-    cart.free();
-    if (!cart.load(data, size)) {
-        cart.free();
+bool nes_load_rom(NESRef nes, const uint8_t *data, size_t size) {
+    if (!nes) {
         return false;
     }
-    bus.cartridge = &cart;
-    ppu.connectCartridge(&cart);
-    hasCart = true;
-    reset();
-    return true;
+    return nes->loadRom(data, size);
 }
 
-void NES::reset() {
-    apu.reset();
-    cpu.reset();
+void nes_reset(NESRef nes) {
+    if (!nes) {
+        return;
+    }
+    nes->reset();
 }
 
-void NES::stepFrame() {
-    if (!hasCart) {
+void nes_step_frame(NESRef nes) {
+    if (!nes) {
         return;
     }
-    ppu.resetFrame();
-    while (!ppu.frameComplete) {
-        int cycles = cpu.step();
-        if (cycles > 0) {
-            for (int i = 0; i < cycles * 3; i++) {
-                ppu.tick();
-                if (ppu.nmiRequested) {
-                    cpu.nmi();
-                }
-            }
-        }
+    nes->stepFrame();
+}
+
+void nes_skip_frame(NESRef nes) {
+    if (!nes) {
+        return;
     }
+    nes->stepFrame(false);
 }
 
-NESRef nes_create(void) {
-    return new NES();
+const uint32_t *nes_framebuffer(NESRef nes) {
+    if (!nes) {
+        return NULL;
+    }
+    if (nes->frames.attached()) {
+        return nes->frames.newest();
+    }
+    return nes->frameBuffer.pixels;
 }
 
-void nes_destroy(NESRef nes) {
-    delete nes;
+int nes_framebuffer_width(void) { return NES_WIDTH; }
+int nes_framebuffer_height(void) { return NES_HEIGHT; }
+
+void nes_set_frame_buffers(NESRef nes, uint32_t *const *buffers) {
+    if (!nes) {
+        return;
+    }
+    nes->setFrameBuffers(buffers);
 }
 
-bool nes_load_rom(NESRef nes, const uint8_t *data, size_t size) {
+const uint32_t *nes_acquire_frame(NESRef nes, uint64_t *sequence) {
     if (!nes) {
-        return false;
+        return NULL;
     }
-    return nes->loadRom(data, size);
+    return nes->frames.acquire(sequence);
 }
 
-void nes_reset(NESRef nes) {
+void nes_set_indexed_output(NESRef nes, bool enabled) {
     if (!nes) {
         return;
     }
-    nes->reset();
+    nes->ppu.setIndexedOutput(enabled);
 }
 
-void nes_step_frame(NESRef nes) {
+const uint8_t *nes_framebuffer_indexed(NESRef nes) {
+    if (!nes) {
+        return NULL;
+    }
+    return nes->indexedFrame.pixels;
+}
+
+const uint8_t *nes_framebuffer_emphasis(NESRef nes) {
     if (!nes) {
+        return NULL;
+    }
+    return nes->indexedFrame.emphasis;
+}
+
+int nes_pixel_format_size(NesPixelFormat format) {
+    return pixel_format_size(format);
+}
+
+void nes_convert_frame(NESRef nes, NesPixelFormat format, void *out, int stride) {
+    if (!nes || !out) {
         return;
     }
-    nes->stepFrame();
+    convert_indexed_frame(&nes->indexedFrame, format, out, stride);
 }
 
-const uint32_t *nes_framebuffer(NESRef nes) {
+void nes_filter_frame_ntsc(NESRef nes, uint32_t *out, int stride) {
+    if (!nes || !out) {
+        return;
+    }
+    ntsc_filter_frame(&nes->indexedFrame, out, stride);
+}
+
+void nes_set_output_scale(NESRef nes, NesOutputScale scale, bool crop_overscan) {
+    if (!nes) {
+        return;
+    }
+    nes->ppu.setOutputScale(scale, crop_overscan);
+}
+
+const uint32_t *nes_output_framebuffer(NESRef nes) {
     if (!nes) {
         return NULL;
     }
-    return nes->ppu.frameBuffer.pixels;
+    if (nes->ppu.outputScale != NES_SCALE_FULL) {
+        return nes->scaledFrame.pixels;
+    }
+    return nes_framebuffer(nes);
 }
 
-int nes_framebuffer_width(void) { return NES_WIDTH; }
-int nes_framebuffer_height(void) { return NES_HEIGHT; }
+int nes_output_width(NESRef nes) {
+    if (!nes) {
+        return 0;
+    }
+    return nes->ppu.outputWidth();
+}
+
+int nes_output_height(NESRef nes) {
+    if (!nes) {
+        return 0;
+    }
+    return nes->ppu.outputHeight();
+}
+
+void nes_set_band_callback(NESRef nes, NesBandFunc func, void *context, int band_rows) {
+    if (!nes) {
+        return;
+    }
+    nes->ppu.setBandCallback(func, context, band_rows);
+}
+
+void nes_set_change_tracking(NESRef nes, bool enabled) {
+    if (!nes) {
+        return;
+    }
+    nes->ppu.setChangeTracking(enabled);
+}
+
+bool nes_frame_unchanged(NESRef nes) {
+    if (!nes) {
+        return false;
+    }
+    return nes->ppu.frameUnchanged();
+}
+
+const uint32_t *nes_frame_dirty_blocks(NESRef nes) {
+    if (!nes || !nes->ppu.trackChanges) {
+        return NULL;
+    }
+    return nes->frameDiff.dirty;
+}
+
+void nes_set_pipelined_render(NESRef nes, bool enabled) {
+    if (!nes) {
+        return;
+    }
+    nes->setPipelined(enabled);
+}
+
+void nes_set_ppu_mode(NESRef nes, NesPpuMode mode) {
+    if (!nes) {
+        return;
+    }
+    nes->setPpuMode(mode);
+}
 
 void nes_set_button(NESRef nes, uint8_t button, bool pressed) {
     if (!nes) {
@@ -104,16 +193,44 @@ void nes_set_button(NESRef nes, uint8_t button, bool pressed) {
     nes->bus.controller.setButton(button, pressed);
 }
 
-float nes_apu_next_sample(NESRef nes, double sample_rate) {
+void nes_set_sprite_limit(NESRef nes, bool enabled) {
+    if (!nes) {
+        return;
+    }
+    nes->ppu.spriteLimit = enabled;
+}
+
+void nes_set_background_plane(NESRef nes, bool enabled) {
+    if (!nes) {
+        return;
+    }
+    nes->ppu.setBackgroundPlane(enabled);
+}
+
+void nes_set_audio_rate(NESRef nes, double sample_rate) {
+    if (!nes) {
+        return;
+    }
+    nes->audio.setRate(sample_rate);
+}
+
+int nes_audio_read(NESRef nes, float *out, int count) {
+    if (!nes || !out) {
+        return 0;
+    }
+    return nes->audio.read(out, count);
+}
+
+int nes_audio_available(NESRef nes) {
     if (!nes) {
-        return 0.0f;
+        return 0;
     }
-    return nes->apu.nextSample(sample_rate);
+    return nes->audio.available();
 }
 
-void nes_apu_fill_buffer(NESRef nes, double sample_rate, float *out, int count) {
+void nes_set_audio_quality(NESRef nes, NesAudioQuality quality) {
     if (!nes) {
         return;
     }
-    nes->apu.fillBuffer(sample_rate, out, count);
+    nes->apu.setQuality(quality);
 }
@@ -0,0 +1,233 @@
+#include "../include/ntsc_filter.hpp"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The PPU generates its composite signal at 8 samples per pixel, 12 per colour
+// subcarrier cycle, and each scanline starts 4 samples later in the cycle than
+// the one above. Three input pixels (24 samples, two cycles) become seven
+// output pixels, so the decoder only needs one set of filter kernels per
+// output position in that group and per line phase.
+#define NTSC_SAMPLES 8
+#define NTSC_TAPS 16
+#define NTSC_PAD 16
+#define NTSC_CHUNKS (NES_NTSC_WIDTH / 7)
+#define NTSC_LINE_SAMPLES (NTSC_PAD + NTSC_CHUNKS * 3 * NTSC_SAMPLES + NTSC_PAD)
+
+static_assert(NTSC_CHUNKS * 7 == NES_NTSC_WIDTH, "NTSC output must be whole groups of seven");
+
+// Voltage levels from the wiki's NTSC description, normalised to black..white.
+static const float signal_low[4] = {0.350f, 0.518f, 0.962f, 1.550f};
+static const float signal_high[4] = {1.094f, 1.506f, 1.962f, 1.962f};
+static const float signal_black = 0.518f;
+static const float signal_white = 1.962f;
+static const float emphasis_attenuation = 0.746f;
+static const float hue_offset = 4.0f;
+static const float chroma_gain = 2.0f;
+
+static bool in_color_phase(int hue, int phase) {
+    return (hue + phase) % 12 < 6;
+}
+
+struct NtscTables {
+    // Composite samples of every colour for each starting phase, and the
+    // decoding kernels producing B, G and R (scaled to 0..255) from the
+    // NTSC_TAPS samples starting at `start` relative to the group.
+    alignas(32) float signal[3][512][NTSC_SAMPLES];
+    alignas(32) float kernels[3][7][3][NTSC_TAPS];
+    int start[7];
+
+    NtscTables() {
+        for (int p = 0; p < 3; p++) {
+            for (int color = 0; color < 512; color++) {
+                int hue = color & 0x0F;
+                int level = (color >> 4) & 0x03;
+                int emphasis = color >> 6;
+                if (hue > 13) {
+                    level = 1;
+                }
+                float low = signal_low[level];
+                float high = signal_high[level];
+                if (hue == 0) low = high;
+                if (hue > 12) high = low;
+                for (int s = 0; s < NTSC_SAMPLES; s++) {
+                    int phase = (p * 4 + s) % 12;
+                    float v = in_color_phase(hue, phase) ? high : low;
+                    if (((emphasis & 0x01) && in_color_phase(0, phase)) ||
+                        ((emphasis & 0x02) && in_color_phase(4, phase)) ||
+                        ((emphasis & 0x04) && in_color_phase(8, phase))) {
+                        v *= emphasis_attenuation;
+                    }
+                    signal[p][color][s] = (v - signal_black) / (signal_white - signal_black);
+                }
+            }
+        }
+
+        // Output pixel m of a group is centred 24 * (m + 0.5) / 7 samples in,
+        // less the 8 samples of border that centre 602 pixels over 256. Luma
+        // and chroma are both averaged over one subcarrier cycle around it.
+        for (int m = 0; m < 7; m++) {
+            float center = (m + 0.5f) * 24.0f / 7.0f - 8.0f;
+            start[m] = (int)floorf(center - 6.0f);
+            for (int p = 0; p < 3; p++) {
+                for (int t = 0; t < NTSC_TAPS; t++) {
+                    float left = (float)(start[m] + t);
+                    float overlap = fminf(left + 1.0f, center + 6.0f) - fmaxf(left, center - 6.0f);
+                    float w = overlap > 0.0f ? overlap / 12.0f : 0.0f;
+                    int phase = ((p * 4 + start[m] + t) % 12 + 12) % 12;
+                    float angle = (float)M_PI * ((float)phase + hue_offset) / 6.0f;
+                    float y = w;
+                    float i = w * chroma_gain * cosf(angle);
+                    float q = w * chroma_gain * sinf(angle);
+                    kernels[p][m][0][t] = 255.0f * (y - 1.108545f * i + 1.709007f * q);
+                    kernels[p][m][1][t] = 255.0f * (y - 0.274788f * i - 0.635691f * q);
+                    kernels[p][m][2][t] = 255.0f * (y + 0.946882f * i + 0.623557f * q);
+                }
+            }
+        }
+    }
+};
+
+static const NtscTables &ntsc_tables() {
+    static const NtscTables tables;
+    return tables;
+}
+
+static inline uint32_t pack_scalar(float b, float g, float r) {
+    int c[3] = {(int)lrintf(b), (int)lrintf(g), (int)lrintf(r)};
+    for (int k = 0; k < 3; k++) {
+        c[k] = c[k] < 0 ? 0 : (c[k] > 255 ? 255 : c[k]);
+    }
+    return 0xFF000000u | ((uint32_t)c[2] << 16) | ((uint32_t)c[1] << 8) | (uint32_t)c[0];
+}
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+
+static void decode_group(const float *samples, const float (*kernels)[3][NTSC_TAPS], const int *start,
+                         uint32_t *out) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t alpha = {0.0f, 0.0f, 0.0f, 255.0f};
+    const float32x4_t limit = vdupq_n_f32(255.0f);
+    for (int m = 0; m < 7; m++) {
+        const float *s = samples + start[m];
+        float32x4_t acc[3] = {zero, zero, zero};
+        for (int t = 0; t < NTSC_TAPS; t += 4) {
+            float32x4_t v = vld1q_f32(s + t);
+            for (int c = 0; c < 3; c++) {
+                acc[c] = vfmaq_f32(acc[c], v, vld1q_f32(kernels[m][c] + t));
+            }
+        }
+        float32x4_t sum = vpaddq_f32(vpaddq_f32(acc[0], acc[1]), vpaddq_f32(acc[2], zero));
+        sum = vminq_f32(vmaxq_f32(vaddq_f32(sum, alpha), zero), limit);
+        uint16x4_t narrow = vmovn_u32(vcvtnq_u32_f32(sum));
+        uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+        out[m] = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    }
+}
+
+#elif defined(__SSE2__)
+
+static inline uint32_t pack_sse(__m128 b, __m128 g, __m128 r) {
+    const __m128 zero = _mm_setzero_ps();
+    __m128 bg = _mm_add_ps(_mm_unpacklo_ps(b, g), _mm_unpackhi_ps(b, g));
+    __m128 rz = _mm_add_ps(_mm_unpacklo_ps(r, zero), _mm_unpackhi_ps(r, zero));
+    __m128 sum = _mm_add_ps(_mm_movelh_ps(bg, rz), _mm_movehl_ps(rz, bg));
+    sum = _mm_add_ps(sum, _mm_setr_ps(0.0f, 0.0f, 0.0f, 255.0f));
+    sum = _mm_min_ps(_mm_max_ps(sum, zero), _mm_set1_ps(255.0f));
+    __m128i words = _mm_cvtps_epi32(sum);
+    words = _mm_packs_epi32(words, words);
+    return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+}
+
+#if defined(__AVX2__)
+
+static void decode_group(const float *samples, const float (*kernels)[3][NTSC_TAPS], const int *start,
+                         uint32_t *out) {
+    for (int m = 0; m < 7; m++) {
+        const float *s = samples + start[m];
+        __m256 lo = _mm256_loadu_ps(s);
+        __m256 hi = _mm256_loadu_ps(s + 8);
+        __m128 acc[3];
+        for (int c = 0; c < 3; c++) {
+            __m256 sum = _mm256_mul_ps(lo, _mm256_load_ps(kernels[m][c]));
+#if defined(__FMA__)
+            sum = _mm256_fmadd_ps(hi, _mm256_load_ps(kernels[m][c] + 8), sum);
+#else
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(hi, _mm256_load_ps(kernels[m][c] + 8)));
+#endif
+            acc[c] = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        }
+        out[m] = pack_sse(acc[0], acc[1], acc[2]);
+    }
+}
+
+#else
+
+static void decode_group(const float *samples, const float (*kernels)[3][NTSC_TAPS], const int *start,
+                         uint32_t *out) {
+    for (int m = 0; m < 7; m++) {
+        const float *s = samples + start[m];
+        __m128 acc[3] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+        for (int t = 0; t < NTSC_TAPS; t += 4) {
+            __m128 v = _mm_loadu_ps(s + t);
+            for (int c = 0; c < 3; c++) {
+                acc[c] = _mm_add_ps(acc[c], _mm_mul_ps(v, _mm_load_ps(kernels[m][c] + t)));
+            }
+        }
+        out[m] = pack_sse(acc[0], acc[1], acc[2]);
+    }
+}
+
+#endif
+
+#else
+
+static void decode_group(const float *samples, const float (*kernels)[3][NTSC_TAPS], const int *start,
+                         uint32_t *out) {
+    for (int m = 0; m < 7; m++) {
+        const float *s = samples + start[m];
+        float acc[3] = {0.0f, 0.0f, 0.0f};
+        for (int t = 0; t < NTSC_TAPS; t++) {
+            for (int c = 0; c < 3; c++) {
+                acc[c] += s[t] * kernels[m][c][t];
+            }
+        }
+        out[m] = pack_scalar(acc[0], acc[1], acc[2]);
+    }
+}
+
+#endif
+
+// `phase` is the line's position in the three-line subcarrier pattern. The
+// two columns past the right edge and the borders decode as black.
+void ntsc_filter_row(const uint8_t *indices, uint8_t emphasis, int phase, uint32_t *out) {
+    const NtscTables &tables = ntsc_tables();
+    alignas(32) float samples[NTSC_LINE_SAMPLES];
+    memset(samples, 0, sizeof(samples));
+    phase %= 3;
+    int color = (emphasis & 0x07) << 6;
+    float *line = samples + NTSC_PAD;
+    for (int x = 0; x < NES_WIDTH; x++) {
+        memcpy(line + x * NTSC_SAMPLES, tables.signal[(phase + 2 * x) % 3][color | (indices[x] & 0x3F)],
+               sizeof(float) * NTSC_SAMPLES);
+    }
+    for (int chunk = 0; chunk < NTSC_CHUNKS; chunk++) {
+        decode_group(line + chunk * 3 * NTSC_SAMPLES, tables.kernels[phase], tables.start, out + chunk * 7);
+    }
+}
+
+void ntsc_filter_frame(const IndexedFrameBuffer *frame, uint32_t *out, int stride) {
+    uint8_t *bytes = (uint8_t *)out;
+    for (int y = 0; y < NES_HEIGHT; y++) {
+        ntsc_filter_row(frame->pixels + y * NES_WIDTH, frame->emphasis[y], y % 3,
+                        (uint32_t *)(bytes + (size_t)y * stride));
+    }
+}
@@ -0,0 +1,101 @@
+#include "../include/pattern_cache.hpp"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+void PatternCache::reset() {
+    memset(sources, 0, sizeof(sources));
+    memset(valid, 0, sizeof(valid));
+}
+
+void PatternCache::invalidate(uint8_t *const *chrPages, uint16_t addr) {
+    const uint8_t *page = chrPages[(addr >> 10) & 0x07];
+    uint64_t bit = 1ULL << ((addr >> 4) & 0x3F);
+    for (int slot = 0; slot < 8; slot++) {
+        if (sources[slot] == page) {
+            valid[slot] &= ~bit;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+
+// Spreads one plane byte per row across the eight pixels of that row, two
+// rows per vector, and turns each selected bit into the plane's colour bit.
+static inline __m128i pattern_expand(__m128i rows, __m128i select, uint8_t value) {
+    __m128i hit = _mm_cmpeq_epi8(_mm_and_si128(rows, select), select);
+    return _mm_and_si128(hit, _mm_set1_epi8((char)value));
+}
+
+static void pattern_decode(uint8_t *out, uint8_t *flipped, const uint8_t *planes) {
+    const __m128i forward = _mm_setr_epi8((char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                          (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m128i reverse = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+                                          0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80);
+    __m128i lo = _mm_loadl_epi64((const __m128i *)planes);
+    __m128i hi = _mm_loadl_epi64((const __m128i *)(planes + 8));
+    lo = _mm_unpacklo_epi8(lo, lo);
+    hi = _mm_unpacklo_epi8(hi, hi);
+    __m128i lo4[2] = {_mm_unpacklo_epi16(lo, lo), _mm_unpackhi_epi16(lo, lo)};
+    __m128i hi4[2] = {_mm_unpacklo_epi16(hi, hi), _mm_unpackhi_epi16(hi, hi)};
+    for (int half = 0; half < 2; half++) {
+        __m128i lo8[2] = {_mm_unpacklo_epi32(lo4[half], lo4[half]), _mm_unpackhi_epi32(lo4[half], lo4[half])};
+        __m128i hi8[2] = {_mm_unpacklo_epi32(hi4[half], hi4[half]), _mm_unpackhi_epi32(hi4[half], hi4[half])};
+        for (int pair = 0; pair < 2; pair++) {
+            int offset = (half * 2 + pair) * 16;
+            __m128i a = _mm_or_si128(pattern_expand(lo8[pair], forward, 1), pattern_expand(hi8[pair], forward, 2));
+            __m128i b = _mm_or_si128(pattern_expand(lo8[pair], reverse, 1), pattern_expand(hi8[pair], reverse, 2));
+            _mm_store_si128((__m128i *)(out + offset), a);
+            _mm_store_si128((__m128i *)(flipped + offset), b);
+        }
+    }
+}
+
+#elif defined(__ARM_NEON)
+
+static void pattern_decode(uint8_t *out, uint8_t *flipped, const uint8_t *planes) {
+    static const uint8_t forwardBits[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01};
+    static const uint8_t reverseBits[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+    const uint8x8_t forward = vld1_u8(forwardBits);
+    const uint8x8_t reverse = vld1_u8(reverseBits);
+    const uint8x8_t one = vdup_n_u8(1);
+    const uint8x8_t two = vdup_n_u8(2);
+    for (int y = 0; y < 8; y++) {
+        uint8x8_t lo = vdup_n_u8(planes[y]);
+        uint8x8_t hi = vdup_n_u8(planes[y + 8]);
+        uint8x8_t a = vorr_u8(vand_u8(vtst_u8(lo, forward), one), vand_u8(vtst_u8(hi, forward), two));
+        uint8x8_t b = vorr_u8(vand_u8(vtst_u8(lo, reverse), one), vand_u8(vtst_u8(hi, reverse), two));
+        vst1_u8(out + y * 8, a);
+        vst1_u8(flipped + y * 8, b);
+    }
+}
+
+#else
+
+static void pattern_decode(uint8_t *out, uint8_t *flipped, const uint8_t *planes) {
+    for (int y = 0; y < 8; y++) {
+        uint8_t plane0 = planes[y];
+        uint8_t plane1 = planes[y + 8];
+        for (int x = 0; x < 8; x++) {
+            int bit = 7 - x;
+            uint8_t color = (uint8_t)(((plane1 >> bit) & 0x01) << 1 | ((plane0 >> bit) & 0x01));
+            out[y * 8 + x] = color;
+            flipped[y * 8 + 7 - x] = color;
+        }
+    }
+}
+
+#endif
+
+void PatternCache::decode(int tile, const uint8_t *planes) {
+    if (!planes) {
+        memset(tiles[tile], 0, sizeof(tiles[tile]));
+        return;
+    }
+    pattern_decode(tiles[tile][0], tiles[tile][1], planes);
+}
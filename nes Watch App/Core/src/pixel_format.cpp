@@ -0,0 +1,240 @@
+#include "../include/pixel_format.hpp"
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+static const uint32_t nes_palette[64] = {
+    0xFF7C7C7C, 0xFF0000FC, 0xFF0000BC, 0xFF4428BC, 0xFF940084, 0xFFA80020, 0xFFA81000, 0xFF881400,
+    0xFF503000, 0xFF007800, 0xFF006800, 0xFF005800, 0xFF004058, 0xFF000000, 0xFF000000, 0xFF000000,
+    0xFFBCBCBC, 0xFF0078F8, 0xFF0058F8, 0xFF6844FC, 0xFFD800CC, 0xFFE40058, 0xFFF83800, 0xFFE45C10,
+    0xFFAC7C00, 0xFF00B800, 0xFF00A800, 0xFF00A844, 0xFF008888, 0xFF000000, 0xFF000000, 0xFF000000,
+    0xFFF8F8F8, 0xFF3CBCFC, 0xFF6888FC, 0xFF9878F8, 0xFFF878F8, 0xFFF85898, 0xFFF87858, 0xFFFCA044,
+    0xFFF8B800, 0xFFB8F818, 0xFF58D854, 0xFF58F898, 0xFF00E8D8, 0xFF787878, 0xFF000000, 0xFF000000,
+    0xFFFCFCFC, 0xFFA4E4FC, 0xFFB8B8F8, 0xFFD8B8F8, 0xFFF8B8F8, 0xFFF8A4C0, 0xFFF0D0B0, 0xFFFCE0A8,
+    0xFFF8D878, 0xFFD8F878, 0xFFB8F8B8, 0xFFB8F8D8, 0xFF00FCFC, 0xFFF8D8F8, 0xFF000000, 0xFF000000
+};
+
+// Emphasis dims the colour channels that are not emphasised (bit 0 red,
+// bit 1 green, bit 2 blue).
+uint32_t palette_argb(uint8_t index, uint8_t emphasis) {
+    uint32_t color = nes_palette[index & 0x3F];
+    if (emphasis == 0) {
+        return color;
+    }
+    uint32_t r = (color >> 16) & 0xFF;
+    uint32_t g = (color >> 8) & 0xFF;
+    uint32_t b = color & 0xFF;
+    if ((emphasis & 0x01) == 0) r = r * 3 / 4;
+    if ((emphasis & 0x02) == 0) g = g * 3 / 4;
+    if ((emphasis & 0x04) == 0) b = b * 3 / 4;
+    return (color & 0xFF000000) | (r << 16) | (g << 8) | b;
+}
+
+int pixel_format_size(NesPixelFormat format) {
+    switch (format) {
+        case NES_PIXEL_RGB565:
+            return 2;
+        case NES_PIXEL_GRAY8:
+            return 1;
+        default:
+            return 4;
+    }
+}
+
+// One 64-byte lookup table per output byte, per emphasis setting. Table
+// lookups on 64 entries map directly onto TBL (NEON) or four PSHUFBs (SSSE3).
+typedef enum {
+    CHANNEL_B,
+    CHANNEL_G,
+    CHANNEL_R,
+    CHANNEL_GRAY,
+    CHANNEL_565_LO,
+    CHANNEL_565_HI,
+    CHANNEL_COUNT
+} PaletteChannel;
+
+struct PaletteTables {
+    alignas(16) uint8_t channel[8][CHANNEL_COUNT][64];
+
+    PaletteTables() {
+        for (int e = 0; e < 8; e++) {
+            for (int i = 0; i < 64; i++) {
+                uint32_t color = palette_argb((uint8_t)i, (uint8_t)e);
+                uint32_t r = (color >> 16) & 0xFF;
+                uint32_t g = (color >> 8) & 0xFF;
+                uint32_t b = color & 0xFF;
+                uint16_t rgb565 = (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+                channel[e][CHANNEL_B][i] = (uint8_t)b;
+                channel[e][CHANNEL_G][i] = (uint8_t)g;
+                channel[e][CHANNEL_R][i] = (uint8_t)r;
+                channel[e][CHANNEL_GRAY][i] = (uint8_t)((r * 77 + g * 150 + b * 29) >> 8);
+                channel[e][CHANNEL_565_LO][i] = (uint8_t)(rgb565 & 0xFF);
+                channel[e][CHANNEL_565_HI][i] = (uint8_t)(rgb565 >> 8);
+            }
+        }
+    }
+};
+
+static const PaletteTables &palette_tables() {
+    static const PaletteTables tables;
+    return tables;
+}
+
+static void convert_scalar(const uint8_t *indices, const uint8_t (*tables)[64], NesPixelFormat format,
+                           uint8_t *out, int from, int width) {
+    for (int x = from; x < width; x++) {
+        uint8_t i = indices[x] & 0x3F;
+        switch (format) {
+            case NES_PIXEL_BGRA8888:
+                out[x * 4 + 0] = tables[CHANNEL_B][i];
+                out[x * 4 + 1] = tables[CHANNEL_G][i];
+                out[x * 4 + 2] = tables[CHANNEL_R][i];
+                out[x * 4 + 3] = 0xFF;
+                break;
+            case NES_PIXEL_RGBA8888:
+                out[x * 4 + 0] = tables[CHANNEL_R][i];
+                out[x * 4 + 1] = tables[CHANNEL_G][i];
+                out[x * 4 + 2] = tables[CHANNEL_B][i];
+                out[x * 4 + 3] = 0xFF;
+                break;
+            case NES_PIXEL_RGB565:
+                out[x * 2 + 0] = tables[CHANNEL_565_LO][i];
+                out[x * 2 + 1] = tables[CHANNEL_565_HI][i];
+                break;
+            case NES_PIXEL_GRAY8:
+                out[x] = tables[CHANNEL_GRAY][i];
+                break;
+        }
+    }
+}
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+
+static int convert_simd(const uint8_t *indices, const uint8_t (*tables)[64], NesPixelFormat format,
+                        uint8_t *out, int width) {
+    const uint8x16_t limit = vdupq_n_u8(0x3F);
+    const uint8x16_t alpha = vdupq_n_u8(0xFF);
+    uint8x16x4_t b = vld1q_u8_x4(tables[CHANNEL_B]);
+    uint8x16x4_t g = vld1q_u8_x4(tables[CHANNEL_G]);
+    uint8x16x4_t r = vld1q_u8_x4(tables[CHANNEL_R]);
+    uint8x16x4_t gray = vld1q_u8_x4(tables[CHANNEL_GRAY]);
+    uint8x16x4_t lo = vld1q_u8_x4(tables[CHANNEL_565_LO]);
+    uint8x16x4_t hi = vld1q_u8_x4(tables[CHANNEL_565_HI]);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t i = vandq_u8(vld1q_u8(indices + x), limit);
+        switch (format) {
+            case NES_PIXEL_BGRA8888: {
+                uint8x16x4_t px = {{vqtbl4q_u8(b, i), vqtbl4q_u8(g, i), vqtbl4q_u8(r, i), alpha}};
+                vst4q_u8(out + x * 4, px);
+                break;
+            }
+            case NES_PIXEL_RGBA8888: {
+                uint8x16x4_t px = {{vqtbl4q_u8(r, i), vqtbl4q_u8(g, i), vqtbl4q_u8(b, i), alpha}};
+                vst4q_u8(out + x * 4, px);
+                break;
+            }
+            case NES_PIXEL_RGB565: {
+                uint8x16x2_t px = {{vqtbl4q_u8(lo, i), vqtbl4q_u8(hi, i)}};
+                vst2q_u8(out + x * 2, px);
+                break;
+            }
+            case NES_PIXEL_GRAY8:
+                vst1q_u8(out + x, vqtbl4q_u8(gray, i));
+                break;
+        }
+    }
+    return x;
+}
+
+#elif defined(__SSSE3__)
+
+static inline __m128i lookup64(const __m128i *table, __m128i i) {
+    __m128i low = _mm_and_si128(i, _mm_set1_epi8(0x0F));
+    __m128i high = _mm_and_si128(_mm_srli_epi16(i, 4), _mm_set1_epi8(0x03));
+    __m128i result = _mm_setzero_si128();
+    for (int k = 0; k < 4; k++) {
+        __m128i hit = _mm_cmpeq_epi8(high, _mm_set1_epi8((char)k));
+        result = _mm_or_si128(result, _mm_and_si128(_mm_shuffle_epi8(table[k], low), hit));
+    }
+    return result;
+}
+
+static inline void store_quads(uint8_t *out, __m128i c0, __m128i c1, __m128i c2, __m128i c3) {
+    __m128i c01lo = _mm_unpacklo_epi8(c0, c1);
+    __m128i c01hi = _mm_unpackhi_epi8(c0, c1);
+    __m128i c23lo = _mm_unpacklo_epi8(c2, c3);
+    __m128i c23hi = _mm_unpackhi_epi8(c2, c3);
+    _mm_storeu_si128((__m128i *)(out + 0), _mm_unpacklo_epi16(c01lo, c23lo));
+    _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi16(c01lo, c23lo));
+    _mm_storeu_si128((__m128i *)(out + 32), _mm_unpacklo_epi16(c01hi, c23hi));
+    _mm_storeu_si128((__m128i *)(out + 48), _mm_unpackhi_epi16(c01hi, c23hi));
+}
+
+static int convert_simd(const uint8_t *indices, const uint8_t (*tables)[64], NesPixelFormat format,
+                        uint8_t *out, int width) {
+    __m128i channel[CHANNEL_COUNT][4];
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+        for (int k = 0; k < 4; k++) {
+            channel[c][k] = _mm_load_si128((const __m128i *)(tables[c] + k * 16));
+        }
+    }
+    const __m128i alpha = _mm_set1_epi8((char)0xFF);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i i = _mm_loadu_si128((const __m128i *)(indices + x));
+        switch (format) {
+            case NES_PIXEL_BGRA8888:
+                store_quads(out + x * 4, lookup64(channel[CHANNEL_B], i), lookup64(channel[CHANNEL_G], i),
+                            lookup64(channel[CHANNEL_R], i), alpha);
+                break;
+            case NES_PIXEL_RGBA8888:
+                store_quads(out + x * 4, lookup64(channel[CHANNEL_R], i), lookup64(channel[CHANNEL_G], i),
+                            lookup64(channel[CHANNEL_B], i), alpha);
+                break;
+            case NES_PIXEL_RGB565: {
+                __m128i lo = lookup64(channel[CHANNEL_565_LO], i);
+                __m128i hi = lookup64(channel[CHANNEL_565_HI], i);
+                _mm_storeu_si128((__m128i *)(out + x * 2), _mm_unpacklo_epi8(lo, hi));
+                _mm_storeu_si128((__m128i *)(out + x * 2 + 16), _mm_unpackhi_epi8(lo, hi));
+                break;
+            }
+            case NES_PIXEL_GRAY8:
+                _mm_storeu_si128((__m128i *)(out + x), lookup64(channel[CHANNEL_GRAY], i));
+                break;
+        }
+    }
+    return x;
+}
+
+#else
+
+static int convert_simd(const uint8_t *indices, const uint8_t (*tables)[64], NesPixelFormat format,
+                        uint8_t *out, int width) {
+    (void)indices;
+    (void)tables;
+    (void)format;
+    (void)out;
+    (void)width;
+    return 0;
+}
+
+#endif
+
+void convert_indexed_row(const uint8_t *indices, uint8_t emphasis, NesPixelFormat format, void *out, int width) {
+    const uint8_t (*tables)[64] = palette_tables().channel[emphasis & 0x07];
+    uint8_t *bytes = (uint8_t *)out;
+    int done = convert_simd(indices, tables, format, bytes, width);
+    convert_scalar(indices, tables, format, bytes, done, width);
+}
+
+void convert_indexed_frame(const IndexedFrameBuffer *frame, NesPixelFormat format, void *out, int stride) {
+    uint8_t *bytes = (uint8_t *)out;
+    for (int y = 0; y < NES_HEIGHT; y++) {
+        convert_indexed_row(frame->pixels + y * NES_WIDTH, frame->emphasis[y], format, bytes + (size_t)y * stride,
+                            NES_WIDTH);
+    }
+}
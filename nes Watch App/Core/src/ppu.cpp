@@ -1,29 +1,12 @@
 #include "../include/ppu.hpp"
 
-static const uint32_t nes_palette[64] = {
-    0xFF7C7C7C, 0xFF0000FC, 0xFF0000BC, 0xFF4428BC, 0xFF940084, 0xFFA80020, 0xFFA81000, 0xFF881400,
-    0xFF503000, 0xFF007800, 0xFF006800, 0xFF005800, 0xFF004058, 0xFF000000, 0xFF000000, 0xFF000000,
-    0xFFBCBCBC, 0xFF0078F8, 0xFF0058F8, 0xFF6844FC, 0xFFD800CC, 0xFFE40058, 0xFFF83800, 0xFFE45C10,
-    0xFFAC7C00, 0xFF00B800, 0xFF00A800, 0xFF00A844, 0xFF008888, 0xFF000000, 0xFF000000, 0xFF000000,
-    0xFFF8F8F8, 0xFF3CBCFC, 0xFF6888FC, 0xFF9878F8, 0xFFF878F8, 0xFFF85898, 0xFFF87858, 0xFFFCA044,
-    0xFFF8B800, 0xFFB8F818, 0xFF58D854, 0xFF58F898, 0xFF00E8D8, 0xFF787878, 0xFF000000, 0xFF000000,
-    0xFFFCFCFC, 0xFFA4E4FC, 0xFFB8B8F8, 0xFFD8B8F8, 0xFFF8B8F8, 0xFFF8A4C0, 0xFFF0D0B0, 0xFFFCE0A8,
-    0xFFF8D878, 0xFFD8F878, 0xFFB8F8B8, 0xFFB8F8D8, 0xFF00FCFC, 0xFFF8D8F8, 0xFF000000, 0xFF000000
-};
-
-int PPU::mirrorNametable(uint16_t addr) {
-    int offset = (int)(addr & 0x0FFF);
-    Mirroring activeMirroring = cartridge ? cartridge->mirroring : mirroring;
-    if (activeMirroring == MIRROR_VERTICAL) {
-        return offset & 0x07FF;
-    }
-    int table = (offset / 0x400) & 0x03;
-    int index = offset & 0x03FF;
-    if (table == 0 || table == 1) {
-        return index;
-    }
-    return 0x400 + index;
-}
+#include "../include/mapper/mapper_list.hpp"
+#include "../include/downscale.hpp"
+#include "../include/pixel_format.hpp"
+#include "../include/render_pipeline.hpp"
+
+#include <chrono>
+#include <type_traits>
 
 int PPU::mirrorPalette(uint16_t addr) {
     int index = (int)(addr & 0x001F);
@@ -34,152 +17,852 @@ int PPU::mirrorPalette(uint16_t addr) {
     return index;
 }
 
-uint32_t PPU::paletteColor(int palette, int color) {
-    uint16_t indexAddr = (color == 0) ? 0x3F00 : (uint16_t)(0x3F00 + palette * 4 + color);
-    uint8_t paletteIndex = (uint8_t)(readMemory(indexAddr) & 0x3F);
-    return nes_palette[paletteIndex % 64];
+// PPUMASK bit 0 forces grey and bits 5-7 set colour emphasis; both are folded
+// into the cached palette entries rather than applied in the pixel loops.
+uint8_t PPU::resolveIndex(uint8_t value) const {
+    return (uint8_t)(value & ((render.mask & 0x01) != 0 ? 0x30 : 0x3F));
 }
 
-uint32_t PPU::spritePaletteColor(int palette, int color) {
-    uint16_t indexAddr = (uint16_t)(0x3F10 + palette * 4 + color);
-    uint8_t paletteIndex = (uint8_t)(readMemory(indexAddr) & 0x3F);
-    return nes_palette[paletteIndex % 64];
+void PPU::refreshPalette() {
+    for (int i = 0; i < 32; i++) {
+        setPaletteEntry(i, render.palette[mirrorPalette((uint16_t)i)]);
+    }
 }
 
-void PPU::renderBackgroundScanline(int y) {
-    int width = NES_WIDTH;
-    bool showBackground = (mask & 0x08) != 0;
-    bool showLeftBackground = (mask & 0x02) != 0;
-    uint16_t patternBase = (ctrl & 0x10) != 0 ? 0x1000 : 0x0000;
-    int baseNTX = (ctrl & 0x01) != 0 ? 1 : 0;
-    int baseNTY = (ctrl & 0x02) != 0 ? 1 : 0;
+void PPU::setPaletteEntry(int index, uint8_t value) {
+    uint8_t resolved = resolveIndex(value);
+    paletteIndices[index] = resolved;
+    paletteColors[index] = palette_argb(resolved, (uint8_t)(render.mask >> 5));
+}
+
+template <class Pixel>
+Pixel *PPU::outputRow(int y) {
+    if constexpr (std::is_same_v<Pixel, uint8_t>) {
+        return indexedFrame->pixels + y * NES_WIDTH;
+    } else if (outputScale != NES_SCALE_FULL) {
+        return lines->scaleLines[y & 1];
+    } else {
+        return frameBuffer->pixels + y * NES_WIDTH;
+    }
+}
+
+template <class Pixel>
+const Pixel *PPU::outputPalette() const {
+    if constexpr (std::is_same_v<Pixel, uint8_t>) {
+        return paletteIndices;
+    } else {
+        return paletteColors;
+    }
+}
 
-    int scrolledY = (y + (int)scrollY) & 0x1FF;
+void PPU::logWrite(uint8_t reg, uint8_t value, uint8_t index) {
+    PpuLogEntry entry;
+    entry.scanline = (uint16_t)scanline;
+    entry.dot = (uint16_t)cycle;
+    entry.reg = reg;
+    entry.value = value;
+    entry.index = index;
+    if (dotRender) {
+        applyLogEntry(entry);
+        return;
+    }
+    appendLog(entry);
+    if (pipeline) {
+        pipeline->log(entry);
+    }
+}
+
+void PPU::appendLog(const PpuLogEntry &entry) {
+    if (lines->logCount == PPU_LOG_CAPACITY) {
+        applyPendingLog();
+    }
+    lines->log[lines->logCount++] = entry;
+}
+
+// Returns true when the entry copies the temporary address into v, which
+// moves the scroll origin immediately rather than at the next reload.
+bool PPU::applyLogEntry(const PpuLogEntry &entry) {
+    uint8_t value = entry.value;
+    switch (entry.reg) {
+        case PPU_LOG_CTRL:
+            render.ctrl = value;
+            render.tempAddr = (uint16_t)((render.tempAddr & ~0x0C00) | ((value & 0x03) << 10));
+            return false;
+        case PPU_LOG_MASK: {
+            uint8_t changed = (uint8_t)(render.mask ^ value);
+            render.mask = value;
+            if ((changed & 0xE1) != 0) {
+                refreshPalette();
+            }
+            return false;
+        }
+        case PPU_LOG_SCROLL_X:
+            render.tempAddr = (uint16_t)((render.tempAddr & ~0x001F) | (value >> 3));
+            render.fineX = value & 0x07;
+            return false;
+        case PPU_LOG_SCROLL_Y:
+            render.tempAddr = (uint16_t)((render.tempAddr & ~0x73E0) | ((value & 0x07) << 12) | ((value >> 3) << 5));
+            return false;
+        case PPU_LOG_ADDR_HIGH:
+            render.tempAddr = (uint16_t)((render.tempAddr & 0x00FF) | ((value & 0x3F) << 8));
+            return false;
+        case PPU_LOG_ADDR_LOW:
+            render.tempAddr = (uint16_t)((render.tempAddr & 0xFF00) | value);
+            render.originY = (uint16_t)(((render.tempAddr >> 5) & 0x1F) * 8 + ((render.tempAddr >> 12) & 0x07));
+            render.originNTY = (uint8_t)((render.tempAddr >> 11) & 0x01);
+            render.originLine = (int16_t)(entry.dot < 256 ? entry.scanline : entry.scanline + 1);
+            return true;
+        case PPU_LOG_PALETTE: {
+            render.palette[entry.index] = value;
+            setPaletteEntry(entry.index, value);
+            if ((entry.index & 0x03) == 0) {
+                setPaletteEntry(entry.index | 0x10, value);
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+void PPU::applyPendingLog() {
+    for (int i = 0; i < lines->logCount; i++) {
+        if (applyLogEntry(lines->log[i])) {
+            render.originX = horizontalOrigin();
+        }
+    }
+    lines->logCount = 0;
+}
+
+uint16_t PPU::horizontalOrigin() const {
+    return (uint16_t)(((render.tempAddr >> 10) & 0x01) * 256 + (render.tempAddr & 0x1F) * 8 + render.fineX);
+}
+
+int PPU::planeRow(int y) const {
+    int scrolledY = (y - render.originLine + (int)render.originY) & 0x1FF;
     int tileY = (scrolledY / 8) % 30;
-    int fineY = scrolledY % 8;
-    int ntY = ((scrolledY / 240) + baseNTY) & 0x01;
-
-    for (int x = 0; x < width; x++) {
-        if (!showBackground || (x < 8 && !showLeftBackground)) {
-            uint32_t pixelColor = paletteColor(0, 0);
-            frameBuffer.pixels[y * width + x] = pixelColor;
-            bgColorIndex[y * width + x] = 0;
-            continue;
+    int ntY = ((scrolledY / 240) + render.originNTY) & 0x01;
+    return ntY * 240 + tileY * 8 + scrolledY % 8;
+}
+
+void PPU::startScanline(int y) {
+    beginScanline(y);
+    evaluateSpriteZero(y);
+    evaluateSpriteOverflow(y);
+}
+
+void PPU::beginScanline(int y) {
+    applyPendingLog();
+    if (y == 0) {
+        render.originX = horizontalOrigin();
+        render.originY = (uint16_t)(((render.tempAddr >> 5) & 0x1F) * 8 + ((render.tempAddr >> 12) & 0x07));
+        render.originNTY = (uint8_t)((render.tempAddr >> 11) & 0x01);
+        render.originLine = 0;
+    }
+}
+
+// Draws scanline y once the PPU has passed its last dot. Writes logged during
+// the line split it into segments at the pixel they landed on; the
+// horizontal scroll for the next line is latched at dot 257 as on hardware.
+template <bool Render>
+void PPU::finishScanline(int y) {
+    if (Render && outputScale != NES_SCALE_FULL) {
+        finishScaledScanline(y);
+        return;
+    }
+    if (Render && indexedOutput) {
+        indexedFrame->emphasis[y] = (uint8_t)(render.mask >> 5);
+        replayScanline<Render, uint8_t>(y);
+    } else {
+        replayScanline<Render, uint32_t>(y);
+    }
+    if (Render) {
+        completeRow(y);
+    }
+}
+
+// Dot renderer output: the composited palette entries of line y go through
+// the same indexed, ARGB and scaled paths as a replayed scanline.
+template <bool Render>
+void PPU::finishDotScanline(int y) {
+    if constexpr (Render) {
+        if (outputScale != NES_SCALE_FULL) {
+            emitDotLine<uint32_t>(y);
+            reduceScaledRow(y);
+            return;
+        }
+        if (indexedOutput) {
+            indexedFrame->emphasis[y] = (uint8_t)(render.mask >> 5);
+            emitDotLine<uint8_t>(y);
+        } else {
+            emitDotLine<uint32_t>(y);
         }
+        completeRow(y);
+    }
+}
 
-        int scrolledX = (x + (int)scrollX) & 0x1FF;
-        int tileX = (scrolledX / 8) % 32;
-        int fineX = scrolledX % 8;
-        int ntX = ((scrolledX / 256) + baseNTX) & 0x01;
-        uint16_t baseNameTable = (uint16_t)(0x2000 + ((ntY << 1) | ntX) * 0x400);
-        uint16_t nameAddr = (uint16_t)(baseNameTable + tileY * 32 + tileX);
-        uint8_t tileId = readMemory(nameAddr);
-        uint16_t patternAddr = (uint16_t)(patternBase + (uint16_t)tileId * 16 + (uint16_t)fineY);
-        uint8_t plane0 = readMemory(patternAddr);
-        uint8_t plane1 = readMemory(patternAddr + 8);
-        int bit = 7 - fineX;
-        int color = ((plane1 >> bit) & 0x01) << 1 | ((plane0 >> bit) & 0x01);
+template <class Pixel>
+void PPU::emitDotLine(int y) {
+    Pixel *row = outputRow<Pixel>(y);
+    const Pixel *palette = outputPalette<Pixel>();
+    const uint8_t *entries = lines->background;
+    for (int x = 0; x < NES_WIDTH; x++) {
+        row[x] = palette[entries[x]];
+    }
+}
 
-        uint16_t attrAddr = (uint16_t)(baseNameTable + 0x03C0 + (tileY / 4) * 8 + (tileX / 4));
-        uint8_t attr = readMemory(attrAddr);
-        int quadrantX = (tileX % 4) / 2;
-        int quadrantY = (tileY % 4) / 2;
-        int shift = (quadrantY * 2 + quadrantX) * 2;
-        int palette = (attr >> shift) & 0x03;
+// Change tracking and band delivery for a finished full-size row.
+void PPU::completeRow(int y) {
+    if (trackChanges) {
+        if (indexedOutput) {
+            hashRow(y, indexedFrame->pixels + y * NES_WIDTH, NES_WIDTH / NES_DIFF_BLOCK, NES_DIFF_BLOCK,
+                    indexedFrame->emphasis[y]);
+        } else {
+            hashRow(y, (const uint8_t *)(frameBuffer->pixels + y * NES_WIDTH), NES_WIDTH / NES_DIFF_BLOCK,
+                    NES_DIFF_BLOCK * (int)sizeof(uint32_t), 0);
+        }
+    }
+    if (bandFunc) {
+        deliverRows(y + 1);
+    }
+}
+
+template <bool Render, class Pixel>
+void PPU::replayScanline(int y) {
+    uint8_t lineCtrl = render.ctrl;
+    uint8_t lineMask = render.mask;
+    Pixel spriteColors[16];
+    if (Render) {
+        memcpy(spriteColors, outputPalette<Pixel>() + 0x10, sizeof(spriteColors));
+    }
+
+    int x = 0;
+    bool latched = false;
+    uint16_t nextOriginX = 0;
+    for (int i = 0; i < lines->logCount; i++) {
+        const PpuLogEntry &entry = lines->log[i];
+        int boundary = entry.dot < 1 ? 0 : (entry.dot > NES_WIDTH ? NES_WIDTH : entry.dot - 1);
+        if (Render && boundary > x) {
+            renderBackgroundSegment<Pixel>(y, x, boundary);
+            x = boundary;
+        }
+        if (entry.dot > 257 && !latched) {
+            nextOriginX = horizontalOrigin();
+            latched = true;
+        }
+        if (applyLogEntry(entry)) {
+            if (entry.dot > 257) {
+                nextOriginX = horizontalOrigin();
+            } else {
+                render.originX = (uint16_t)((horizontalOrigin() - boundary) & 0x1FF);
+            }
+        }
+    }
+    lines->logCount = 0;
 
-        uint32_t pixelColor = paletteColor(palette, color);
-        frameBuffer.pixels[y * width + x] = pixelColor;
-        bgColorIndex[y * width + x] = (uint8_t)color;
+    if (Render) {
+        if (x < NES_WIDTH) {
+            renderBackgroundSegment<Pixel>(y, x, NES_WIDTH);
+        }
+        renderSpritesScanline<Pixel>(y, lineCtrl, lineMask, spriteColors);
     }
+    render.originX = latched ? nextOriginX : horizontalOrigin();
 }
 
-void PPU::renderSpritesScanline(int y) {
-    bool showSprites = (mask & 0x10) != 0;
-    bool showLeftSprites = (mask & 0x04) != 0;
-    if (!showSprites) {
+// Scaled output draws each source line into a two-line ring and reduces it
+// into the small frame. Lines that contribute nothing (overscan when cropping,
+// odd lines when point sampling) only replay their register writes.
+void PPU::finishScaledScanline(int y) {
+    int top = cropOverscan ? NES_OVERSCAN_LINES : 0;
+    int line = y - top;
+    bool visible = line >= 0 && y < NES_HEIGHT - top;
+    if (!visible || (outputScale == NES_SCALE_HALF_POINT && (line & 1) != 0)) {
+        replayScanline<false, uint32_t>(y);
         return;
     }
+    replayScanline<true, uint32_t>(y);
+    reduceScaledRow(y);
+}
 
-    int width = NES_WIDTH;
-    int spriteHeight = (ctrl & 0x20) != 0 ? 16 : 8;
-    uint16_t spriteTable = (ctrl & 0x08) != 0 ? 0x1000 : 0x0000;
+// Reduces the line ring into the small frame once line y has been drawn there.
+void PPU::reduceScaledRow(int y) {
+    int top = cropOverscan ? NES_OVERSCAN_LINES : 0;
+    int line = y - top;
+    if (line < 0 || y >= NES_HEIGHT - top) {
+        return;
+    }
+    uint32_t *out = scaledFrame->pixels + (line >> 1) * (NES_WIDTH / 2);
+    if (outputScale == NES_SCALE_HALF_POINT) {
+        if ((line & 1) != 0) {
+            return;
+        }
+        downscale_point_row(lines->scaleLines[y & 1], out, NES_WIDTH / 2);
+    } else if ((line & 1) != 0) {
+        downscale_box_rows(lines->scaleLines[(y - 1) & 1], lines->scaleLines[y & 1], out, NES_WIDTH / 2);
+    } else {
+        return;
+    }
+    if (trackChanges) {
+        hashRow(line >> 1, (const uint8_t *)out, NES_WIDTH / 2 / NES_DIFF_BLOCK, NES_DIFF_BLOCK * (int)sizeof(uint32_t),
+                0);
+    }
+    if (bandFunc) {
+        deliverRows((line >> 1) + 1);
+    }
+}
 
-    for (int i = 63; i >= 0; i--) {
-        int base = i * 4;
-        int spriteY = (int)oam[base] + 1;
-        uint8_t tileId = oam[base + 1];
-        uint8_t attr = oam[base + 2];
-        int spriteX = (int)oam[base + 3];
+void PPU::hashRow(int row, const uint8_t *pixels, int columns, int blockBytes, uint64_t seed) {
+    for (int c = 0; c < columns; c++) {
+        uint64_t hash = (row % NES_DIFF_BLOCK) == 0 ? 0 : changes->pending[c];
+        hash = (hash ^ seed) * 0x9E3779B97F4A7C15ULL;
+        const uint8_t *block = pixels + c * blockBytes;
+        for (int i = 0; i < blockBytes; i += 8) {
+            uint64_t word;
+            memcpy(&word, block + i, sizeof(word));
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+            hash ^= hash >> 29;
+        }
+        changes->pending[c] = hash;
+    }
+    if ((row % NES_DIFF_BLOCK) != NES_DIFF_BLOCK - 1) {
+        return;
+    }
+    int blockRow = row / NES_DIFF_BLOCK;
+    uint32_t dirty = 0;
+    for (int c = 0; c < columns; c++) {
+        if (changes->pending[c] != changes->hashes[blockRow][c]) {
+            changes->hashes[blockRow][c] = changes->pending[c];
+            dirty |= 1u << c;
+        }
+    }
+    changes->dirty[blockRow] = dirty;
+}
 
-        if (y < spriteY || y >= spriteY + spriteHeight) {
-            continue;
+// Hands finished output rows to the band callback once `bandLines` rows have
+// accumulated or the last row of the frame is done. The rows are read in
+// place, so they are only valid for the duration of the call.
+void PPU::deliverRows(int rowsDone) {
+    int height = outputHeight();
+    if (rowsDone - bandStart < bandLines && rowsDone < height) {
+        return;
+    }
+    NesBand band;
+    if (outputScale != NES_SCALE_FULL) {
+        band.pixels = scaledFrame->pixels + bandStart * (NES_WIDTH / 2);
+        band.bytesPerRow = (NES_WIDTH / 2) * (int)sizeof(uint32_t);
+    } else if (indexedOutput) {
+        band.pixels = indexedFrame->pixels + bandStart * NES_WIDTH;
+        band.bytesPerRow = NES_WIDTH;
+    } else {
+        band.pixels = frameBuffer->pixels + bandStart * NES_WIDTH;
+        band.bytesPerRow = NES_WIDTH * (int)sizeof(uint32_t);
+    }
+    band.firstRow = bandStart;
+    band.rowCount = rowsDone - bandStart;
+    band.timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+    bandStart = rowsDone < height ? rowsDone : 0;
+    bandFunc(bandContext, &band);
+}
+
+uint8_t PPU::backgroundIndexAt(int y, int x) {
+    if (x < 8 && (render.mask & 0x02) == 0) {
+        return 0;
+    }
+    int planeY = planeRow(y);
+    int planeX = (render.originX + x) & 0x1FF;
+    int column = planeX >> 3;
+    const uint8_t *page = nametablePages[(planeY / 240) * 2 + (column >> 5)];
+    uint8_t tileId = page[((planeY % 240) / 8) * 32 + (column & 0x1F)];
+    uint16_t patternBase = (render.ctrl & 0x10) != 0 ? 0x1000 : 0x0000;
+    uint16_t patternAddr = (uint16_t)(patternBase + (uint16_t)tileId * 16 + planeY % 8);
+    return patternRow(patternAddr, false)[planeX & 0x07];
+}
+
+// Finds the dot where sprite 0 first overlaps an opaque background pixel on
+// this line. Only sprite 0's own rows are examined, so the flag stays exact
+// whether or not the frame is being drawn.
+void PPU::evaluateSpriteZero(int y) {
+    spriteZeroDot = -1;
+    if ((render.mask & 0x18) != 0x18 || (status & 0x40) != 0 || !cartridge) {
+        return;
+    }
+    int spriteHeight = (render.ctrl & 0x20) != 0 ? 16 : 8;
+    int spriteY = (int)oam[0] + 1;
+    if (y < spriteY || y >= spriteY + spriteHeight) {
+        return;
+    }
+    int spriteX = (int)oam[3];
+    uint8_t pixels[8];
+    memcpy(pixels, spriteRow(y, 0, render.ctrl), sizeof(pixels));
+
+    bool clipLeft = (render.mask & 0x06) != 0x06;
+    int start = (spriteX < 8 && clipLeft) ? 8 - spriteX : 0;
+    int end = spriteX + 8 > NES_WIDTH - 1 ? NES_WIDTH - 1 - spriteX : 8;
+    for (int col = start; col < end; col++) {
+        if (pixels[col] != 0 && backgroundIndexAt(y, spriteX + col) != 0) {
+            spriteZeroDot = spriteX + col + 1;
+            return;
         }
+    }
+}
 
-        int palette = attr & 0x03;
-        bool priorityBehind = (attr & 0x20) != 0;
-        bool flipH = (attr & 0x40) != 0;
-        bool flipV = (attr & 0x80) != 0;
-
-        int row = y - spriteY;
-        int spriteRow = flipV ? (spriteHeight - 1 - row) : row;
-        uint16_t tileIndex;
-        uint16_t patternBase;
-        int fineY;
-
-        if (spriteHeight == 16) {
-            uint16_t table = (tileId & 0x01) != 0 ? 0x1000 : 0x0000;
-            patternBase = table;
-            uint16_t baseTile = (uint16_t)(tileId & 0xFE);
-            tileIndex = (uint16_t)(baseTile + (spriteRow / 8));
-            fineY = spriteRow % 8;
+// Sets the overflow flag from the sprite buckets rather than while drawing, so
+// skipped and pipelined frames report it exactly like drawn ones.
+void PPU::evaluateSpriteOverflow(int y) {
+    if (!spriteLimit || (render.mask & 0x10) == 0) {
+        return;
+    }
+    int spriteHeight = (render.ctrl & 0x20) != 0 ? 16 : 8;
+    if (spritesDirty || spriteListHeight != spriteHeight) {
+        bucketSprites(spriteHeight);
+    }
+    if (lines->spriteCount[y] > 8) {
+        status |= 0x20;
+    }
+}
+
+template <class Pixel>
+void PPU::renderBackgroundSegment(int y, int x0, int x1) {
+    Pixel *row = outputRow<Pixel>(y);
+    uint8_t *indexRow = lines->background;
+    Pixel backdrop = outputPalette<Pixel>()[0];
+
+    if ((render.mask & 0x08) == 0) {
+        for (int x = x0; x < x1; x++) {
+            row[x] = backdrop;
+        }
+        memset(indexRow + x0, 0, (size_t)(x1 - x0));
+        return;
+    }
+
+    if (!planeEnabled || !renderPlaneSegment<Pixel>(y, x0, x1)) {
+        renderTileSegment<Pixel>(y, x0, x1);
+    }
+
+    if ((render.mask & 0x02) == 0) {
+        for (int x = x0; x < x1 && x < 8; x++) {
+            row[x] = backdrop;
+            indexRow[x] = 0;
+        }
+    }
+}
+
+void PPU::markPlane() {
+    if (!plane) {
+        return;
+    }
+    for (int row = 0; row < 60; row++) {
+        plane->dirtyCells[row] = ~0ULL;
+    }
+    plane->dirty = true;
+}
+
+void PPU::markPlaneNametable(int quadrant, int offset) {
+    const uint8_t *page = nametablePages[quadrant];
+    for (int q = 0; q < 4; q++) {
+        if (nametablePages[q] != page) {
+            continue;
+        }
+        int rowBase = (q >> 1) * 30;
+        int columnBase = (q & 0x01) * 32;
+        if (offset < 0x03C0) {
+            plane->dirtyCells[rowBase + offset / 32] |= 1ULL << (columnBase + offset % 32);
         } else {
-            patternBase = spriteTable;
-            tileIndex = tileId;
-            fineY = spriteRow;
+            int attr = offset - 0x03C0;
+            int top = (attr / 8) * 4;
+            uint64_t columns = 0x0FULL << (columnBase + (attr % 8) * 4);
+            for (int row = top; row < top + 4 && row < 30; row++) {
+                plane->dirtyCells[rowBase + row] |= columns;
+            }
         }
+    }
+    plane->dirty = true;
+}
 
-        uint16_t patternAddr = (uint16_t)(patternBase + tileIndex * 16 + fineY);
-        uint8_t plane0 = readMemory(patternAddr);
-        uint8_t plane1 = readMemory(patternAddr + 8);
+void PPU::markPlaneTile(uint16_t addr) {
+    if ((addr & 0x1000) != plane->patternBase) {
+        return;
+    }
+    int tile = (addr >> 4) & 0xFF;
+    plane->changedTiles[tile >> 6] |= 1ULL << (tile & 0x3F);
+    plane->tilesChanged = true;
+}
 
-        for (int col = 0; col < 8; col++) {
-            int x = spriteX + col;
-            if (x < 0 || x >= width) {
-                continue;
+// Brings the plane up to date before scanline y is drawn from it. Past the
+// first line a large refresh is deferred to the next frame and the caller
+// falls back to the tile renderer, so mid-frame CHR splits stay cheap.
+bool PPU::refreshPlane(int y) {
+    uint16_t patternBase = (render.ctrl & 0x10) != 0 ? 0x1000 : 0x0000;
+    if (patternBase != plane->patternBase) {
+        plane->patternBase = patternBase;
+        markPlane();
+    }
+    for (int slot = 0; slot < 4; slot++) {
+        const uint8_t *page = chrPages[(patternBase >> 10) + slot];
+        if (plane->chrSources[slot] != page) {
+            plane->chrSources[slot] = page;
+            plane->changedTiles[slot] = ~0ULL;
+            plane->tilesChanged = true;
+        }
+    }
+    if (plane->tilesChanged) {
+        for (int row = 0; row < 60; row++) {
+            const uint8_t *left = nametablePages[(row / 30) * 2] + (row % 30) * 32;
+            const uint8_t *right = nametablePages[(row / 30) * 2 + 1] + (row % 30) * 32;
+            uint64_t cells = 0;
+            for (int column = 0; column < 32; column++) {
+                uint8_t a = left[column];
+                uint8_t b = right[column];
+                cells |= (uint64_t)((plane->changedTiles[a >> 6] >> (a & 0x3F)) & 0x01) << column;
+                cells |= (uint64_t)((plane->changedTiles[b >> 6] >> (b & 0x3F)) & 0x01) << (column + 32);
             }
-            if (x < 8 && !showLeftSprites) {
-                continue;
+            if (cells != 0) {
+                plane->dirtyCells[row] |= cells;
+                plane->dirty = true;
             }
+        }
+        memset(plane->changedTiles, 0, sizeof(plane->changedTiles));
+        plane->tilesChanged = false;
+    }
+    if (!plane->dirty) {
+        return true;
+    }
+    if (y > 0) {
+        int pending = 0;
+        for (int row = 0; row < 60; row++) {
+            pending += __builtin_popcountll(plane->dirtyCells[row]);
+        }
+        if (pending > 64) {
+            return false;
+        }
+    }
+    for (int row = 0; row < 60; row++) {
+        uint64_t cells = plane->dirtyCells[row];
+        while (cells != 0) {
+            int column = __builtin_ctzll(cells);
+            cells &= cells - 1;
+            rasterizePlaneCell(row, column);
+        }
+        plane->dirtyCells[row] = 0;
+    }
+    plane->dirty = false;
+    return true;
+}
 
-            int fineX = flipH ? col : (7 - col);
-            int bit = fineX;
-            int color = ((plane1 >> bit) & 0x01) << 1 | ((plane0 >> bit) & 0x01);
-            if (color == 0) {
-                continue;
-            }
+void PPU::rasterizePlaneCell(int row, int column) {
+    int tileY = row % 30;
+    int tileX = column & 0x1F;
+    const uint8_t *page = nametablePages[(row / 30) * 2 + (column >> 5)];
+    uint8_t tileId = page[tileY * 32 + tileX];
+    uint8_t attr = page[0x03C0 + (tileY / 4) * 8 + (tileX / 4)];
+    int quadrant = ((tileY % 4) / 2) * 2 + (tileX % 4) / 2;
+    uint8_t palette = (uint8_t)(((attr >> (quadrant * 2)) & 0x03) << 2);
+    for (int fineY = 0; fineY < 8; fineY++) {
+        uint16_t patternAddr = (uint16_t)(plane->patternBase + (uint16_t)tileId * 16 + fineY);
+        const uint8_t *pixels = patterns->row(chrPages, patternAddr, false);
+        uint8_t *out = plane->pixels[row * 8 + fineY] + column * 8;
+        for (int px = 0; px < 8; px++) {
+            out[px] = (uint8_t)(palette | pixels[px]);
+        }
+    }
+}
+
+template <class Pixel>
+bool PPU::renderPlaneSegment(int y, int x0, int x1) {
+    if (!refreshPlane(y)) {
+        return false;
+    }
+
+    Pixel *row = outputRow<Pixel>(y);
+    uint8_t *indexRow = lines->background;
+    const uint8_t *source = plane->pixels[planeRow(y)];
+    const Pixel *entries = outputPalette<Pixel>();
+    Pixel colors[16];
+    for (int i = 0; i < 16; i++) {
+        colors[i] = (i & 0x03) != 0 ? entries[i] : entries[0];
+    }
+
+    int originX = render.originX;
+    for (int x = x0; x < x1; x++) {
+        uint8_t value = source[(originX + x) & 0x1FF];
+        row[x] = colors[value];
+        indexRow[x] = value & 0x03;
+    }
+    return true;
+}
+
+template <class Pixel>
+void PPU::renderTileSegment(int y, int x0, int x1) {
+    Pixel *row = outputRow<Pixel>(y);
+    uint8_t *indexRow = lines->background;
+    const Pixel *palettes = outputPalette<Pixel>();
+    Pixel backdrop = palettes[0];
+    uint16_t patternBase = (render.ctrl & 0x10) != 0 ? 0x1000 : 0x0000;
+
+    int planeY = planeRow(y);
+    int ntY = planeY / 240;
+    int tileY = (planeY % 240) / 8;
+    int fineY = planeY % 8;
+    int quadrantY = (tileY % 4) / 2;
+
+    int planeX = (render.originX + x0) & 0x1FF;
+    int column = planeX >> 3;
+    for (int x = x0 - (planeX & 0x07); x < x1; x += 8, column = (column + 1) & 0x3F) {
+        int tileX = column & 0x1F;
+        const uint8_t *page = nametablePages[ntY * 2 + (column >> 5)];
+        uint8_t tileId = page[tileY * 32 + tileX];
+        uint8_t attr = page[0x03C0 + (tileY / 4) * 8 + (tileX / 4)];
+        uint16_t patternAddr = (uint16_t)(patternBase + (uint16_t)tileId * 16 + (uint16_t)fineY);
+        const uint8_t *pixels = patterns->row(chrPages, patternAddr, false);
+
+        int quadrantX = (tileX % 4) / 2;
+        int palette = (attr >> ((quadrantY * 2 + quadrantX) * 2)) & 0x03;
+        const Pixel *entries = palettes + palette * 4;
+        Pixel colors[4] = {backdrop, entries[1], entries[2], entries[3]};
+
+        int start = x < x0 ? x0 - x : 0;
+        int end = x + 8 > x1 ? x1 - x : 8;
+        for (int px = start; px < end; px++) {
+            uint8_t color = pixels[px];
+            row[x + px] = colors[color];
+            indexRow[x + px] = color;
+        }
+    }
+}
 
-            uint8_t bgIndex = bgColorIndex[y * width + x];
-            if (priorityBehind && bgIndex != 0) {
+// The lists depend on OAM and on the sprite height, which a $2000 write can
+// change mid-frame; each caller rebuilds them when either differs.
+void PPU::bucketSprites(int spriteHeight) {
+    memset(lines->spriteCount, 0, sizeof(lines->spriteCount));
+    for (int i = 0; i < 64; i++) {
+        int top = (int)oam[i * 4] + 1;
+        int last = top + spriteHeight < NES_HEIGHT ? top + spriteHeight : NES_HEIGHT;
+        for (int line = top; line < last; line++) {
+            lines->spriteList[line][lines->spriteCount[line]++] = (uint8_t)i;
+        }
+    }
+    spriteListHeight = (uint8_t)spriteHeight;
+    spritesDirty = false;
+}
+
+// Builds that never draw have no pattern cache; sprite-0 evaluation is then
+// the only reader and decodes its few rows straight from CHR.
+const uint8_t *PPU::patternRow(uint16_t addr, bool flip) {
+    if (patterns) {
+        return patterns->row(chrPages, addr, flip);
+    }
+    const uint8_t *page = chrPages[(addr >> 10) & 0x07];
+    uint8_t plane0 = page ? page[addr & 0x03FF] : 0;
+    uint8_t plane1 = page ? page[(addr & 0x03FF) + 8] : 0;
+    for (int x = 0; x < 8; x++) {
+        int bit = flip ? x : 7 - x;
+        lines->patternRow[x] = (uint8_t)(((plane1 >> bit) & 0x01) << 1 | ((plane0 >> bit) & 0x01));
+    }
+    return lines->patternRow;
+}
+
+const uint8_t *PPU::spriteRow(int y, int sprite, uint8_t spriteCtrl) {
+    int base = sprite * 4;
+    int spriteY = (int)oam[base] + 1;
+    uint8_t tileId = oam[base + 1];
+    uint8_t attr = oam[base + 2];
+    int spriteHeight = (spriteCtrl & 0x20) != 0 ? 16 : 8;
+    bool flipH = (attr & 0x40) != 0;
+    bool flipV = (attr & 0x80) != 0;
+
+    int row = y - spriteY;
+    int spriteRow = flipV ? (spriteHeight - 1 - row) : row;
+    uint16_t tileIndex;
+    uint16_t patternBase;
+    int fineY;
+
+    if (spriteHeight == 16) {
+        uint16_t table = (tileId & 0x01) != 0 ? 0x1000 : 0x0000;
+        patternBase = table;
+        uint16_t baseTile = (uint16_t)(tileId & 0xFE);
+        tileIndex = (uint16_t)(baseTile + (spriteRow / 8));
+        fineY = spriteRow % 8;
+    } else {
+        patternBase = (spriteCtrl & 0x08) != 0 ? 0x1000 : 0x0000;
+        tileIndex = tileId;
+        fineY = spriteRow;
+    }
+
+    uint16_t patternAddr = (uint16_t)(patternBase + tileIndex * 16 + fineY);
+    return patternRow(patternAddr, flipH);
+}
+
+template <class Pixel>
+void PPU::renderSpritesScanline(int y, uint8_t lineCtrl, uint8_t lineMask, const Pixel *spriteColors) {
+    bool showSprites = (lineMask & 0x10) != 0;
+    bool showLeftSprites = (lineMask & 0x04) != 0;
+    if (!showSprites) {
+        return;
+    }
+
+    int spriteHeight = (lineCtrl & 0x20) != 0 ? 16 : 8;
+    if (spritesDirty || spriteListHeight != spriteHeight) {
+        bucketSprites(spriteHeight);
+    }
+    int count = lines->spriteCount[y];
+    if (count > 8 && spriteLimit) {
+        count = 8;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    int width = NES_WIDTH;
+    Pixel *pixelRow = outputRow<Pixel>(y);
+    const uint8_t *background = lines->background;
+    uint8_t *owner = lines->spriteOwner;
+    memset(owner, 0, (size_t)width);
+
+    // Front to back: the first opaque sprite pixel owns its dot even when it
+    // is behind the background, which hides any later sprite there.
+    for (int n = 0; n < count; n++) {
+        int i = lines->spriteList[y][n];
+        uint8_t attr = oam[i * 4 + 2];
+        int spriteX = (int)oam[i * 4 + 3];
+        bool priorityBehind = (attr & 0x20) != 0;
+        const uint8_t *pixels = spriteRow(y, i, lineCtrl);
+        const Pixel *colors = spriteColors + (attr & 0x03) * 4;
+
+        int start = (spriteX < 8 && !showLeftSprites) ? 8 - spriteX : 0;
+        int end = spriteX + 8 > width ? width - spriteX : 8;
+        for (int col = start; col < end; col++) {
+            int x = spriteX + col;
+            int color = pixels[col];
+            if (color == 0 || owner[x] != 0) {
                 continue;
             }
-
-            if (i == 0 && (mask & 0x08) != 0) {
-                status |= 0x40;
+            owner[x] = 1;
+            if (priorityBehind && background[x] != 0) {
+                continue;
             }
-
-            uint32_t pixelColor = spritePaletteColor(palette, color);
-            frameBuffer.pixels[y * width + x] = pixelColor;
+            pixelRow[x] = colors[color];
         }
     }
 }
 
+void PPU::attachMemory(uint8_t *nametables, ScanlineMemory *scanlines, PatternCache *patternCache,
+                       BackgroundPlane *backgroundPlane) {
+    nametableRam = nametables;
+    plane = backgroundPlane;
+    lines = scanlines;
+    lines->logCount = 0;
+    spritesDirty = true;
+    patterns = patternCache;
+    if (patterns) {
+        patterns->reset();
+    }
+    setMirroring(mirroring);
+}
+
 void PPU::connectCartridge(Cartridge *cart) {
     cartridge = cart;
-    mirroring = cart->mirroring;
+    chrPages = cart->mapper->chrPages;
+    if (patterns) {
+        patterns->reset();
+    }
+    setMirroring(cart->mirroring);
+}
+
+void PPU::setBackgroundPlane(bool enabled) {
+    planeEnabled = enabled && plane != nullptr;
+    if (planeEnabled) {
+        memset(plane->chrSources, 0, sizeof(plane->chrSources));
+        markPlane();
+    }
+}
+
+// Switches renderer between frames. The dot renderer applies register writes
+// as they happen, so anything still logged is applied first.
+void PPU::setDotRender(bool enabled) {
+    applyPendingLog();
+    dotRender = enabled;
+    spriteZeroDot = -1;
+    memset(&lines->dot, 0, sizeof(lines->dot));
+}
+
+void PPU::setIndexedOutput(bool enabled) {
+    indexedOutput = enabled && indexedFrame != nullptr;
+}
+
+void PPU::setOutputScale(NesOutputScale scale, bool crop) {
+    outputScale = (uint8_t)(scaledFrame != nullptr ? scale : NES_SCALE_FULL);
+    cropOverscan = crop && outputScale != NES_SCALE_FULL;
+}
+
+// True when drawn frames land in frameBuffer rather than the indexed or
+// scaled frame.
+bool PPU::fullFrameOutput() const {
+    return !indexedOutput && outputScale == NES_SCALE_FULL;
+}
+
+int PPU::outputWidth() const {
+    return outputScale != NES_SCALE_FULL ? NES_WIDTH / 2 : NES_WIDTH;
+}
+
+int PPU::outputHeight() const {
+    int height = cropOverscan ? NES_HEIGHT - 2 * NES_OVERSCAN_LINES : NES_HEIGHT;
+    return outputScale != NES_SCALE_FULL ? height / 2 : height;
+}
+
+void PPU::setMirroring(Mirroring mode) {
+    static const uint8_t layouts[5][4] = {
+        {0, 0, 1, 1},
+        {0, 1, 0, 1},
+        {0, 0, 0, 0},
+        {1, 1, 1, 1},
+        {0, 1, 2, 3}
+    };
+    if (pipeline) {
+        pipeline->mirroring(mode);
+    }
+    mirroring = mode;
+    for (int i = 0; i < 4; i++) {
+        nametablePages[i] = nametableRam + layouts[mode][i] * 0x400;
+    }
+    markPlane();
 }
 
 void PPU::resetFrame() {
     frameComplete = false;
+    bandStart = 0;
+    if (trackChanges) {
+        memset(changes->dirty, 0, sizeof(changes->dirty));
+    }
+}
+
+// Starting from impossible hashes makes the first tracked frame fully dirty.
+void PPU::setChangeTracking(bool enabled) {
+    trackChanges = enabled && changes != nullptr;
+    if (trackChanges) {
+        memset(changes->hashes, 0xFF, sizeof(changes->hashes));
+        memset(changes->dirty, 0xFF, sizeof(changes->dirty));
+    }
+}
+
+bool PPU::frameUnchanged() const {
+    if (!trackChanges) {
+        return false;
+    }
+    for (int i = 0; i < NES_HEIGHT / NES_DIFF_BLOCK; i++) {
+        if (changes->dirty[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PPU::setBandCallback(NesBandFunc func, void *context, int bandRows) {
+    bandFunc = func;
+    bandContext = context;
+    bandLines = bandRows < 1 ? 1 : bandRows;
+    bandStart = 0;
 }
 
 uint8_t PPU::cpuRead(uint16_t addr) {
@@ -205,7 +888,7 @@ uint8_t PPU::cpuRead(uint16_t addr) {
                 value = readBuffer;
                 readBuffer = readMemory(vramAddr);
             }
-            vramAddr += (ctrl & 0x04) != 0 ? 32 : 1;
+            advanceVramAddr();
             dataBus = value;
             return value;
         }
@@ -219,45 +902,64 @@ void PPU::cpuWrite(uint16_t addr, uint8_t data) {
     switch (addr) {
         case 0x2000:
             ctrl = data;
+            logWrite(PPU_LOG_CTRL, data);
             break;
         case 0x2001:
             mask = data;
+            logWrite(PPU_LOG_MASK, data);
             break;
         case 0x2003:
             oamAddr = data;
             break;
         case 0x2004:
-            oam[oamAddr] = data;
-            oamAddr += 1;
+            dmaWriteOam(data);
             break;
         case 0x2005:
-            if (!addressLatch) {
-                scrollX = data;
-                addressLatch = true;
-            } else {
-                scrollY = data;
-                addressLatch = false;
-            }
+            logWrite(addressLatch ? PPU_LOG_SCROLL_Y : PPU_LOG_SCROLL_X, data);
+            addressLatch = !addressLatch;
             break;
         case 0x2006:
             if (!addressLatch) {
-                vramAddr = (uint16_t)(data << 8);
+                if (!dotRender) {
+                    vramAddr = (uint16_t)(data << 8);
+                }
                 addressLatch = true;
+                logWrite(PPU_LOG_ADDR_HIGH, data);
             } else {
                 vramAddr = (uint16_t)((vramAddr & 0xFF00) | data);
                 addressLatch = false;
+                logWrite(PPU_LOG_ADDR_LOW, data);
+                if (dotRender) {
+                    vramAddr = render.tempAddr;
+                }
             }
             break;
         case 0x2007:
             writeMemory(vramAddr, data);
-            vramAddr += (ctrl & 0x04) != 0 ? 32 : 1;
+            advanceVramAddr();
             break;
         default:
             break;
     }
 }
 
+// With the dot renderer, $2007 accesses while rendering bump coarse X and Y
+// the way the fetch pipeline does instead of the programmed increment.
+void PPU::advanceVramAddr() {
+    if (dotRender && (render.mask & 0x18) != 0 && (scanline < NES_HEIGHT || scanline == 261)) {
+        incrementScrollX();
+        incrementScrollY();
+        return;
+    }
+    vramAddr += (ctrl & 0x04) != 0 ? 32 : 1;
+}
+
+template <bool Render, class M, bool Dot>
 void PPU::tick() {
+    if constexpr (Dot) {
+        stepDot<Render, M>();
+        return;
+    }
     nmiRequested = false;
     if (scanline == 241 && cycle == 1) {
         status |= 0x80;
@@ -270,9 +972,25 @@ void PPU::tick() {
         status &= 0x1F;
     }
 
-    if (cycle == 0 && scanline >= 0 && scanline < 240) {
-        renderBackgroundScanline(scanline);
-        renderSpritesScanline(scanline);
+    if (cycle == spriteZeroDot) {
+        status |= 0x40;
+        spriteZeroDot = -1;
+    }
+
+    if (scanline < 240) {
+        if (cycle == 0) {
+            startScanline(scanline);
+            if (pipeline) {
+                pipeline->lineStart(scanline, chrPages);
+            }
+        } else if (cycle == 340) {
+            if (pipeline) {
+                finishScanline<false>(scanline);
+                pipeline->lineFinish(scanline, Render, chrPages);
+            } else {
+                finishScanline<Render>(scanline);
+            }
+        }
     }
 
     cycle += 1;
@@ -286,41 +1004,81 @@ void PPU::tick() {
     }
 }
 
-uint8_t PPU::readMemory(uint16_t addr) {
-    uint16_t address = addr & 0x3FFF;
-    if (address < 0x2000) {
-        uint8_t value = 0;
-        if (cartridge && cartridge->ppuRead(address, &value)) {
-            return value;
-        }
-        return 0;
+template <bool Render, class M, bool Dot>
+bool PPU::run(int dots) {
+    bool nmi = false;
+    for (int i = 0; i < dots; i++) {
+        tick<Render, M, Dot>();
+        nmi = nmi || nmiRequested;
     }
-    if (address < 0x3F00) {
-        int index = mirrorNametable(address);
-        return nametableRam[index];
-    }
-    int paletteIndex = mirrorPalette(address);
-    return paletteRam[paletteIndex];
+    return nmi;
 }
 
+// The scanline path never touches the mapper, so only the dot path is
+// instantiated per mapper type.
+#define NESC_INSTANTIATE_PPU(id, Type)                  \
+    template void PPU::tick<true, Type, true>();        \
+    template void PPU::tick<false, Type, true>();       \
+    template bool PPU::run<true, Type, true>(int dots); \
+    template bool PPU::run<false, Type, true>(int dots);
+NESC_MAPPER_LIST(NESC_INSTANTIATE_PPU)
+NESC_INSTANTIATE_PPU(-1, Mapper)
+#undef NESC_INSTANTIATE_PPU
+template void PPU::tick<true, Mapper, false>();
+template void PPU::tick<false, Mapper, false>();
+template bool PPU::run<true, Mapper, false>(int dots);
+template bool PPU::run<false, Mapper, false>(int dots);
+
+template void PPU::finishScanline<true>(int y);
+template void PPU::finishScanline<false>(int y);
+template void PPU::finishDotScanline<true>(int y);
+template void PPU::finishDotScanline<false>(int y);
+
 void PPU::writeMemory(uint16_t addr, uint8_t data) {
     uint16_t address = addr & 0x3FFF;
     if (address < 0x2000) {
-        if (cartridge) {
-            (void)cartridge->ppuWrite(address, data);
+        if (cartridge && cartridge->ppuWrite(address, data)) {
+            if (pipeline) {
+                pipeline->chrWrite(address, data, chrPages);
+            }
+            patternWritten(address);
         }
         return;
     }
     if (address < 0x3F00) {
-        int index = mirrorNametable(address);
-        nametableRam[index] = data;
+        if (pipeline) {
+            pipeline->nametable(address, data);
+        }
+        writeNametable(address, data);
         return;
     }
     int paletteIndex = mirrorPalette(address);
     paletteRam[paletteIndex] = data;
+    logWrite(PPU_LOG_PALETTE, data, (uint8_t)paletteIndex);
+}
+
+void PPU::patternWritten(uint16_t addr) {
+    if (patterns) {
+        patterns->invalidate(chrPages, addr);
+    }
+    if (planeEnabled) {
+        markPlaneTile(addr);
+    }
+}
+
+void PPU::writeNametable(uint16_t addr, uint8_t data) {
+    uint8_t *entry = &nametablePages[(addr >> 10) & 0x03][addr & 0x03FF];
+    if (planeEnabled && *entry != data) {
+        markPlaneNametable((addr >> 10) & 0x03, addr & 0x03FF);
+    }
+    *entry = data;
 }
 
 void PPU::dmaWriteOam(uint8_t data) {
+    if (pipeline) {
+        pipeline->oam(oamAddr, data);
+    }
     oam[oamAddr] = data;
     oamAddr += 1;
+    spritesDirty = true;
 }
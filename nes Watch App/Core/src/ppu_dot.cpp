@@ -0,0 +1,279 @@
+#include "../include/ppu.hpp"
+
+#include "../include/mapper/mapper_list.hpp"
+
+// Dot renderer: the 2C02 background fetch pipeline and sprite evaluation run
+// per dot from the loopy v/t/x registers. Each visible dot composites one
+// pixel into lines->background as a palette entry (0-31); the finished line
+// goes through the same output paths as the scanline renderer at dot 256.
+
+static uint8_t reverse_bits(uint8_t b) {
+    b = (uint8_t)(((b & 0xF0) >> 4) | ((b & 0x0F) << 4));
+    b = (uint8_t)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+    return (uint8_t)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+}
+
+void PPU::incrementScrollX() {
+    if ((vramAddr & 0x001F) == 31) {
+        vramAddr = (uint16_t)((vramAddr & ~0x001F) ^ 0x0400);
+    } else {
+        vramAddr += 1;
+    }
+}
+
+void PPU::incrementScrollY() {
+    if ((vramAddr & 0x7000) != 0x7000) {
+        vramAddr += 0x1000;
+        return;
+    }
+    vramAddr &= (uint16_t)~0x7000;
+    int coarseY = (vramAddr & 0x03E0) >> 5;
+    if (coarseY == 29) {
+        coarseY = 0;
+        vramAddr ^= 0x0800;
+    } else if (coarseY == 31) {
+        coarseY = 0;
+    } else {
+        coarseY += 1;
+    }
+    vramAddr = (uint16_t)((vramAddr & ~0x03E0) | (coarseY << 5));
+}
+
+void PPU::loadBackgroundShifters() {
+    DotRenderState &dot = lines->dot;
+    dot.patternLow = (uint16_t)((dot.patternLow & 0xFF00) | dot.nextLow);
+    dot.patternHigh = (uint16_t)((dot.patternHigh & 0xFF00) | dot.nextHigh);
+    dot.attributeLow = (uint16_t)((dot.attributeLow & 0xFF00) | ((dot.nextAttribute & 0x01) != 0 ? 0xFF : 0x00));
+    dot.attributeHigh = (uint16_t)((dot.attributeHigh & 0xFF00) | ((dot.nextAttribute & 0x02) != 0 ? 0xFF : 0x00));
+}
+
+// Tile fetches for dots 1-256 and the first two tiles of the next line at
+// 321-336, each spread over eight dots; v advances horizontally after every
+// tile, vertically at 256, and is reloaded from t at 257 and on the
+// pre-render line at 280-304.
+template <class M>
+void PPU::fetchBackgroundDot() {
+    DotRenderState &dot = lines->dot;
+    if ((cycle >= 2 && cycle <= 257) || (cycle >= 321 && cycle <= 337)) {
+        dot.patternLow <<= 1;
+        dot.patternHigh <<= 1;
+        dot.attributeLow <<= 1;
+        dot.attributeHigh <<= 1;
+        uint16_t patternAddr = (uint16_t)(((render.ctrl & 0x10) != 0 ? 0x1000 : 0x0000) + dot.nextTile * 16 +
+                                          ((vramAddr >> 12) & 0x07));
+        switch ((cycle - 1) & 0x07) {
+            case 0:
+                loadBackgroundShifters();
+                dot.nextTile = readMemory<M>((uint16_t)(0x2000 | (vramAddr & 0x0FFF)));
+                break;
+            case 2: {
+                uint8_t attr = readMemory<M>((uint16_t)(0x23C0 | (vramAddr & 0x0C00) | ((vramAddr >> 4) & 0x38) |
+                                                       ((vramAddr >> 2) & 0x07)));
+                int shift = ((vramAddr >> 4) & 0x04) | (vramAddr & 0x02);
+                dot.nextAttribute = (uint8_t)((attr >> shift) & 0x03);
+                break;
+            }
+            case 4:
+                dot.nextLow = readMemory<M>(patternAddr);
+                break;
+            case 6:
+                dot.nextHigh = readMemory<M>((uint16_t)(patternAddr + 8));
+                break;
+            case 7:
+                incrementScrollX();
+                break;
+            default:
+                break;
+        }
+    }
+    if (cycle == 256) {
+        incrementScrollY();
+    } else if (cycle == 257) {
+        vramAddr = (uint16_t)((vramAddr & ~0x041F) | (render.tempAddr & 0x041F));
+    } else if (scanline == 261 && cycle >= 280 && cycle <= 304) {
+        vramAddr = (uint16_t)((vramAddr & ~0x7BE0) | (render.tempAddr & 0x7BE0));
+    }
+}
+
+// Fills secondary OAM with the first eight sprites on the next line. Past the
+// eighth the hardware steps the byte index along with the sprite index, so
+// the overflow flag is set (or missed) from tile, attribute and X bytes.
+void PPU::evaluateSprites(int y) {
+    DotRenderState &dot = lines->dot;
+    int height = (render.ctrl & 0x20) != 0 ? 16 : 8;
+    int count = 0;
+    int n = 0;
+    dot.spriteZeroOnLine = false;
+    for (; n < 64 && count < 8; n++) {
+        int row = y - (int)oam[n * 4];
+        if (row < 0 || row >= height) {
+            continue;
+        }
+        memcpy(dot.secondary + count * 4, oam + n * 4, 4);
+        dot.spriteZeroOnLine = dot.spriteZeroOnLine || n == 0;
+        count += 1;
+    }
+    for (int m = 0; n < 64; n++, m = (m + 1) & 0x03) {
+        int row = y - (int)oam[n * 4 + m];
+        if (row >= 0 && row < height) {
+            status |= 0x20;
+            break;
+        }
+    }
+    memset(dot.secondary + count * 4, 0xFF, (size_t)(8 - count) * 4);
+    dot.spriteCount = (uint8_t)count;
+}
+
+// Pattern fetches for the eight sprite slots at dots 257-320. Unused slots
+// still read tile $FF, as the hardware does, but load transparent rows.
+template <class M>
+void PPU::fetchSpriteDot() {
+    DotRenderState &dot = lines->dot;
+    int phase = (cycle - 257) & 0x07;
+    if (phase != 4 && phase != 6) {
+        return;
+    }
+    int slot = (cycle - 257) >> 3;
+    const uint8_t *entry = dot.secondary + slot * 4;
+    int height = (render.ctrl & 0x20) != 0 ? 16 : 8;
+    uint8_t tile = entry[1];
+    uint8_t attr = entry[2];
+    int row = (scanline - (int)entry[0]) & (height - 1);
+    if ((attr & 0x80) != 0) {
+        row = height - 1 - row;
+    }
+    uint16_t addr;
+    if (height == 16) {
+        addr = (uint16_t)(((tile & 0x01) != 0 ? 0x1000 : 0x0000) + (tile & 0xFE) * 16 + (row & 0x08) * 2 + (row & 0x07));
+    } else {
+        addr = (uint16_t)(((render.ctrl & 0x08) != 0 ? 0x1000 : 0x0000) + tile * 16 + row);
+    }
+    uint8_t bits = readMemory<M>((uint16_t)(addr + (phase == 6 ? 8 : 0)));
+    if (slot >= dot.spriteCount) {
+        bits = 0;
+    } else if ((attr & 0x40) != 0) {
+        bits = reverse_bits(bits);
+    }
+    if (phase == 4) {
+        dot.spriteLow[slot] = bits;
+        dot.spriteAttribute[slot] = attr;
+        dot.spriteX[slot] = entry[3];
+    } else {
+        dot.spriteHigh[slot] = bits;
+    }
+}
+
+// With rendering off the PPU shows the backdrop, or the palette entry v
+// points at while it addresses palette RAM.
+void PPU::composeDot(int x) {
+    const DotRenderState &dot = lines->dot;
+    uint8_t *entries = lines->background;
+    if ((render.mask & 0x18) == 0) {
+        entries[x] = (vramAddr & 0x3F00) == 0x3F00 ? (uint8_t)mirrorPalette(vramAddr) : 0;
+        return;
+    }
+
+    uint8_t backgroundPixel = 0;
+    uint8_t backgroundPalette = 0;
+    if ((render.mask & 0x08) != 0 && (x >= 8 || (render.mask & 0x02) != 0)) {
+        uint16_t bit = (uint16_t)(0x8000 >> render.fineX);
+        backgroundPixel = (uint8_t)(((dot.patternLow & bit) != 0 ? 1 : 0) | ((dot.patternHigh & bit) != 0 ? 2 : 0));
+        backgroundPalette =
+            (uint8_t)(((dot.attributeLow & bit) != 0 ? 1 : 0) | ((dot.attributeHigh & bit) != 0 ? 2 : 0));
+    }
+
+    uint8_t spritePixel = 0;
+    uint8_t spriteAttr = 0;
+    if ((render.mask & 0x10) != 0 && (x >= 8 || (render.mask & 0x04) != 0)) {
+        for (int i = 0; i < dot.spriteCount; i++) {
+            unsigned offset = (unsigned)(x - (int)dot.spriteX[i]);
+            if (offset > 7) {
+                continue;
+            }
+            int shift = 7 - (int)offset;
+            uint8_t pixel = (uint8_t)(((dot.spriteLow[i] >> shift) & 0x01) | (((dot.spriteHigh[i] >> shift) & 0x01) << 1));
+            if (pixel == 0) {
+                continue;
+            }
+            spritePixel = pixel;
+            spriteAttr = dot.spriteAttribute[i];
+            if (i == 0 && dot.spriteZeroOnLine && backgroundPixel != 0 && x != NES_WIDTH - 1) {
+                status |= 0x40;
+            }
+            break;
+        }
+    }
+
+    if (spritePixel != 0 && (backgroundPixel == 0 || (spriteAttr & 0x20) == 0)) {
+        entries[x] = (uint8_t)(0x10 | ((spriteAttr & 0x03) << 2) | spritePixel);
+    } else if (backgroundPixel != 0) {
+        entries[x] = (uint8_t)((backgroundPalette << 2) | backgroundPixel);
+    } else {
+        entries[x] = 0;
+    }
+}
+
+template <bool Render, class M>
+void PPU::stepDot() {
+    nmiRequested = false;
+    if (scanline == 241 && cycle == 1) {
+        status |= 0x80;
+        if ((ctrl & 0x80) != 0) {
+            nmiRequested = true;
+        }
+    }
+
+    bool visible = scanline < NES_HEIGHT;
+    bool prerender = scanline == 261;
+    if (prerender && cycle == 1) {
+        status &= 0x1F;
+    }
+
+    if (visible || prerender) {
+        bool rendering = (render.mask & 0x18) != 0;
+        if (rendering) {
+            fetchBackgroundDot<M>();
+            if (cycle >= 257 && cycle <= 320) {
+                if (cycle == 257) {
+                    if (visible) {
+                        evaluateSprites(scanline);
+                    } else {
+                        lines->dot.spriteCount = 0;
+                    }
+                }
+                oamAddr = 0;
+                fetchSpriteDot<M>();
+            }
+        } else if (cycle == 257) {
+            lines->dot.spriteCount = 0;
+        }
+        if (visible && cycle >= 1 && cycle <= NES_WIDTH) {
+            composeDot(cycle - 1);
+            if (cycle == NES_WIDTH) {
+                finishDotScanline<Render>(scanline);
+            }
+        }
+        // Odd frames drop the last pre-render dot while rendering is on.
+        if (prerender && cycle == 339 && rendering && lines->dot.oddFrame) {
+            cycle = 340;
+        }
+    }
+
+    cycle += 1;
+    if (cycle >= 341) {
+        cycle = 0;
+        scanline += 1;
+        if (scanline >= 262) {
+            scanline = 0;
+            frameComplete = true;
+            lines->dot.oddFrame = !lines->dot.oddFrame;
+        }
+    }
+}
+
+#define NESC_INSTANTIATE_DOT(id, Type)         \
+    template void PPU::stepDot<true, Type>();  \
+    template void PPU::stepDot<false, Type>();
+NESC_MAPPER_LIST(NESC_INSTANTIATE_DOT)
+NESC_INSTANTIATE_DOT(-1, Mapper)
+#undef NESC_INSTANTIATE_DOT
@@ -0,0 +1,273 @@
+#include "../include/render_pipeline.hpp"
+
+#include <stdlib.h>
+
+#include "../include/cartridge.hpp"
+
+// Called between frames. The worker starts from a copy of everything the
+// renderer reads, including log entries still pending for the next line.
+bool RenderPipeline::start(PPU &ppu, const Cartridge &cart) {
+    stop();
+    memory = new PipelineMemory();
+    chrBase = cart.chrROM;
+    chrSize = cart.chrSize;
+    if (cart.hasChrRam) {
+        chrRam = (uint8_t *)malloc(chrSize);
+        if (!chrRam) {
+            delete memory;
+            memory = nullptr;
+            return false;
+        }
+        memcpy(chrRam, chrBase, chrSize);
+    }
+
+    memcpy(memory->nametableRam, ppu.nametableRam, sizeof(memory->nametableRam));
+    for (int i = 0; i < 8; i++) {
+        sentPages[i] = ppu.chrPages[i];
+        memory->chrPages[i] = translatePage(ppu.chrPages[i]);
+    }
+    worker.attachMemory(memory->nametableRam, &memory->scanlines, &memory->patterns, &memory->plane);
+    worker.chrPages = memory->chrPages;
+    worker.setMirroring(ppu.mirroring);
+    worker.render = ppu.render;
+    memcpy(worker.oam, ppu.oam, sizeof(worker.oam));
+    worker.refreshPalette();
+    worker.lines->logCount = ppu.lines->logCount;
+    memcpy(worker.lines->log, ppu.lines->log, sizeof(PpuLogEntry) * (size_t)ppu.lines->logCount);
+    worker.planeEnabled = false;
+
+    source = &ppu;
+    written = 0;
+    framesSent = 0;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    framesDone.store(0, std::memory_order_relaxed);
+    beginFrame();
+    thread = std::thread(&RenderPipeline::workerLoop, this);
+    ppu.pipeline = this;
+    return true;
+}
+
+void RenderPipeline::stop() {
+    if (!source) {
+        return;
+    }
+    RenderCommand command = {};
+    command.type = RENDER_CMD_STOP;
+    push(command);
+    head.notify_one();
+    thread.join();
+    source->pipeline = nullptr;
+    source = nullptr;
+    free(chrRam);
+    chrRam = nullptr;
+    delete memory;
+    memory = nullptr;
+}
+
+// The worker is idle here, so output settings can be copied across directly.
+void RenderPipeline::beginFrame() {
+    worker.frameBuffer = source->frameBuffer;
+    worker.indexedFrame = source->indexedFrame;
+    worker.scaledFrame = source->scaledFrame;
+    worker.changes = source->changes;
+    worker.trackChanges = source->trackChanges;
+    worker.indexedOutput = source->indexedOutput;
+    worker.outputScale = source->outputScale;
+    worker.cropOverscan = source->cropOverscan;
+    worker.spriteLimit = source->spriteLimit;
+    worker.bandFunc = source->bandFunc;
+    worker.bandContext = source->bandContext;
+    worker.bandLines = source->bandLines;
+    if (worker.planeEnabled != source->planeEnabled) {
+        worker.setBackgroundPlane(source->planeEnabled);
+    }
+    worker.resetFrame();
+}
+
+void RenderPipeline::finishFrame() {
+    RenderCommand command = {};
+    command.type = RENDER_CMD_FRAME_END;
+    push(command);
+    head.notify_one();
+    framesSent += 1;
+    uint32_t done = framesDone.load(std::memory_order_acquire);
+    while (done != framesSent) {
+        framesDone.wait(done, std::memory_order_acquire);
+        done = framesDone.load(std::memory_order_acquire);
+    }
+}
+
+void RenderPipeline::log(const PpuLogEntry &entry) {
+    RenderCommand command;
+    command.type = RENDER_CMD_LOG;
+    command.value = entry.value;
+    command.reg = entry.reg;
+    command.index = entry.index;
+    command.addr = entry.scanline;
+    command.dot = entry.dot;
+    push(command);
+}
+
+void RenderPipeline::oam(uint8_t addr, uint8_t data) {
+    RenderCommand command = {};
+    command.type = RENDER_CMD_OAM;
+    command.value = data;
+    command.addr = addr;
+    push(command);
+}
+
+void RenderPipeline::nametable(uint16_t addr, uint8_t data) {
+    RenderCommand command = {};
+    command.type = RENDER_CMD_NAMETABLE;
+    command.value = data;
+    command.addr = addr;
+    push(command);
+}
+
+void RenderPipeline::chrWrite(uint16_t addr, uint8_t data, uint8_t *const *pages) {
+    syncPages(pages);
+    RenderCommand command = {};
+    command.type = RENDER_CMD_CHR_WRITE;
+    command.value = data;
+    command.addr = addr;
+    push(command);
+}
+
+void RenderPipeline::mirroring(Mirroring mode) {
+    RenderCommand command = {};
+    command.type = RENDER_CMD_MIRRORING;
+    command.value = (uint8_t)mode;
+    push(command);
+}
+
+void RenderPipeline::lineStart(int y, uint8_t *const *pages) {
+    syncPages(pages);
+    RenderCommand command = {};
+    command.type = RENDER_CMD_LINE_START;
+    command.addr = (uint16_t)y;
+    push(command);
+}
+
+void RenderPipeline::lineFinish(int y, bool draw, uint8_t *const *pages) {
+    syncPages(pages);
+    RenderCommand command = {};
+    command.type = RENDER_CMD_LINE_FINISH;
+    command.value = draw ? 1 : 0;
+    command.addr = (uint16_t)y;
+    push(command);
+    head.notify_one();
+}
+
+// Mappers switch CHR banks without telling the PPU, so the mapping is compared
+// at every point where the renderer or pattern cache could observe it.
+void RenderPipeline::syncPages(uint8_t *const *pages) {
+    for (int i = 0; i < 8; i++) {
+        if (pages[i] == sentPages[i]) {
+            continue;
+        }
+        sentPages[i] = pages[i];
+        RenderCommand command = {};
+        command.type = RENDER_CMD_CHR_PAGE;
+        command.index = (uint8_t)i;
+        command.value = pages[i] != nullptr ? 1 : 0;
+        command.addr = pages[i] != nullptr ? (uint16_t)((pages[i] - chrBase) / MAPPER_CHR_PAGE_SIZE) : 0;
+        push(command);
+    }
+}
+
+uint8_t *RenderPipeline::translatePage(const uint8_t *page) const {
+    if (!page) {
+        return nullptr;
+    }
+    if (chrRam) {
+        return chrRam + (page - chrBase);
+    }
+    return (uint8_t *)page;
+}
+
+void RenderPipeline::push(const RenderCommand &command) {
+    uint32_t consumed = tail.load(std::memory_order_acquire);
+    while (written - consumed == RENDER_RING_CAPACITY) {
+        head.notify_one();
+        tail.wait(consumed, std::memory_order_acquire);
+        consumed = tail.load(std::memory_order_acquire);
+    }
+    memory->ring[written % RENDER_RING_CAPACITY] = command;
+    written += 1;
+    head.store(written, std::memory_order_release);
+}
+
+void RenderPipeline::workerLoop() {
+    uint32_t position = 0;
+    for (;;) {
+        uint32_t end = head.load(std::memory_order_acquire);
+        if (position == end) {
+            head.wait(end, std::memory_order_acquire);
+            continue;
+        }
+        while (position != end) {
+            const RenderCommand &command = memory->ring[position % RENDER_RING_CAPACITY];
+            if (command.type == RENDER_CMD_STOP) {
+                return;
+            }
+            execute(command);
+            position += 1;
+        }
+        tail.store(position, std::memory_order_release);
+        tail.notify_one();
+    }
+}
+
+void RenderPipeline::execute(const RenderCommand &command) {
+    switch (command.type) {
+        case RENDER_CMD_LOG: {
+            PpuLogEntry entry;
+            entry.scanline = command.addr;
+            entry.dot = command.dot;
+            entry.reg = command.reg;
+            entry.value = command.value;
+            entry.index = command.index;
+            worker.appendLog(entry);
+            break;
+        }
+        case RENDER_CMD_OAM:
+            worker.oam[command.addr] = command.value;
+            worker.spritesDirty = true;
+            break;
+        case RENDER_CMD_NAMETABLE:
+            worker.writeNametable(command.addr, command.value);
+            break;
+        case RENDER_CMD_CHR_WRITE: {
+            uint8_t *page = memory->chrPages[command.addr >> 10];
+            if (page) {
+                page[command.addr & (MAPPER_CHR_PAGE_SIZE - 1)] = command.value;
+                worker.patternWritten(command.addr);
+            }
+            break;
+        }
+        case RENDER_CMD_CHR_PAGE:
+            memory->chrPages[command.index] =
+                command.value != 0 ? translatePage(chrBase + (size_t)command.addr * MAPPER_CHR_PAGE_SIZE) : nullptr;
+            break;
+        case RENDER_CMD_MIRRORING:
+            worker.setMirroring((Mirroring)command.value);
+            break;
+        case RENDER_CMD_LINE_START:
+            worker.beginScanline(command.addr);
+            break;
+        case RENDER_CMD_LINE_FINISH:
+            if (command.value != 0) {
+                worker.finishScanline<true>(command.addr);
+            } else {
+                worker.finishScanline<false>(command.addr);
+            }
+            break;
+        case RENDER_CMD_FRAME_END:
+            framesDone.fetch_add(1, std::memory_order_release);
+            framesDone.notify_one();
+            break;
+        default:
+            break;
+    }
+}
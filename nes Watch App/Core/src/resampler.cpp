@@ -0,0 +1,155 @@
+#include "../include/resampler.hpp"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Passband edge as a fraction of the lower of the two Nyquist rates.
+#define RESAMPLER_ROLLOFF 0.9
+// The producer's rate control moves the ratio by 0.5% at most; anything
+// beyond this is a real rate change and gets a new filter bank.
+#define RESAMPLER_REDESIGN_TOLERANCE 0.01
+
+static const int resampler_taps[3] = {8, 16, 32};
+static const int resampler_phase_bits[3] = {6, 7, 8};
+
+// Q15 taps times 16-bit samples; every quality uses a multiple of eight taps.
+#if defined(__SSE2__)
+static int resampler_dot(const int16_t *x, const int16_t *h, int taps) {
+    __m128i sum = _mm_setzero_si128();
+    for (int k = 0; k < taps; k += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(x + k));
+        __m128i b = _mm_load_si128((const __m128i *)(h + k));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, b));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+static int resampler_dot(const int16_t *x, const int16_t *h, int taps) {
+    int32x4_t sum = vdupq_n_s32(0);
+    for (int k = 0; k < taps; k += 8) {
+        int16x8_t a = vld1q_s16(x + k);
+        int16x8_t b = vld1q_s16(h + k);
+        sum = vmlal_s16(sum, vget_low_s16(a), vget_low_s16(b));
+        sum = vmlal_high_s16(sum, a, b);
+    }
+    return vaddvq_s32(sum);
+}
+#else
+static int resampler_dot(const int16_t *x, const int16_t *h, int taps) {
+    int sum = 0;
+    for (int k = 0; k < taps; k++) {
+        sum += x[k] * h[k];
+    }
+    return sum;
+}
+#endif
+
+void Resampler::init() {
+    quality = NES_AUDIO_QUALITY_MEDIUM;
+    taps = resampler_taps[quality];
+    phaseBits = resampler_phase_bits[quality];
+    ratio = 1.0;
+    designRatio = 0.0;
+    step = 1ULL << 32;
+    clear();
+}
+
+void Resampler::clear() {
+    position = 0;
+    count = 0;
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void Resampler::setQuality(NesAudioQuality value) {
+    if (value < NES_AUDIO_QUALITY_LOW || value > NES_AUDIO_QUALITY_HIGH || value == quality) {
+        return;
+    }
+    quality = value;
+    taps = resampler_taps[quality];
+    phaseBits = resampler_phase_bits[quality];
+    buildBank();
+}
+
+void Resampler::setRates(double inputRate, double outputRate) {
+    ratio = outputRate / inputRate;
+    step = (uint64_t)(inputRate / outputRate * (double)(1ULL << 32) + 0.5);
+    if (fabs(ratio - designRatio) > designRatio * RESAMPLER_REDESIGN_TOLERANCE) {
+        buildBank();
+    }
+}
+
+// Phase p holds the taps for an output falling p / phases of the way past the
+// first sample of its window. Each row sums to exactly unity so a constant
+// input passes unchanged.
+void Resampler::buildBank() {
+    const double pi = 3.141592653589793;
+    double cutoff = 0.5 * RESAMPLER_ROLLOFF * (ratio < 1.0 ? ratio : 1.0);
+    int half = taps / 2;
+    int phases = 1 << phaseBits;
+    for (int phase = 0; phase < phases; phase++) {
+        double shift = (double)phase / phases;
+        double row[RESAMPLER_MAX_TAPS];
+        double total = 0.0;
+        for (int k = 0; k < taps; k++) {
+            double x = (double)(k - (half - 1)) - shift;
+            double sinc = x == 0.0 ? 2.0 * cutoff : sin(2.0 * pi * cutoff * x) / (pi * x);
+            double w = x / half;
+            double window = 0.42 + 0.5 * cos(pi * w) + 0.08 * cos(2.0 * pi * w);
+            row[k] = sinc * window;
+            total += row[k];
+        }
+        int16_t *out = bank + phase * taps;
+        int sum = 0;
+        int peak = 0;
+        for (int k = 0; k < taps; k++) {
+            out[k] = (int16_t)lround(row[k] / total * 32768.0);
+            sum += out[k];
+            if (out[k] > out[peak]) {
+                peak = k;
+            }
+        }
+        out[peak] = (int16_t)(out[peak] + 32768 - sum);
+    }
+    designRatio = ratio;
+}
+
+// Appends the input and emits every output whose window is complete; samples
+// no later output can reach are dropped from the front.
+int Resampler::process(const int *input, int inputCount, int *out, int capacity) {
+    int room = RESAMPLER_BUFFER_SIZE - count;
+    int n = inputCount < room ? inputCount : room;
+    for (int i = 0; i < n; i++) {
+        int x = input[i];
+        buffer[count + i] = (int16_t)(x > 32767 ? 32767 : (x < -32768 ? -32768 : x));
+    }
+    count += n;
+
+    int produced = 0;
+    while (produced < capacity) {
+        int base = (int)(position >> 32);
+        if (base + taps > count) {
+            break;
+        }
+        int phase = (int)((uint32_t)position >> (32 - phaseBits));
+        int sum = resampler_dot(buffer + base, bank + phase * taps, taps);
+        out[produced++] = (sum + (1 << 14)) >> 15;
+        position += step;
+    }
+
+    int consumed = (int)(position >> 32);
+    if (consumed > count) {
+        consumed = count;
+    }
+    memmove(buffer, buffer + consumed, (size_t)(count - consumed) * sizeof(int16_t));
+    count -= consumed;
+    position -= (uint64_t)consumed << 32;
+    return produced;
+}
@@ -74,9 +74,13 @@ final class EmulatorViewModel: ObservableObject {
         timer?.cancel()
         let timer = DispatchSource.makeTimerSource(queue: emuQueue)
         timer.schedule(deadline: .now(), repeating: 1.0 / 60.0)
+        core.setChangeTracking(true)
         timer.setEventHandler { [weak self] in
             guard let self else { return }
             self.core.stepFrame()
+            if self.core.frameUnchanged() {
+                return
+            }
             let image = self.core.currentFrameImage()
             Task { @MainActor in
                 self.frameImage = image